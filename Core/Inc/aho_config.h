@@ -3,11 +3,111 @@
 
 #include <stdint.h>
 
+// Limites das tabelas estáticas. Os valores abaixo são os do firmware; o
+// build do host (Host/Makefile) os redefine para feeds inteiros de
+// assinaturas.
+#ifndef AC_MAX_VERTICES
 #define AC_MAX_VERTICES 160
+#endif
+#ifndef AC_MAX_PATTERNS
 #define AC_MAX_PATTERNS 80
+#endif
+#ifndef AC_MAX_PATTERNS_PER_VERTEX
 #define AC_MAX_PATTERNS_PER_VERTEX 2
-#define AC_MAX_TRANSITIONS_PER_VERTEX 12
+#endif
+
+// Índices de vértice/aresta e de padrão: o menor inteiro que comporta os
+// limites (uint8_t no firmware). O valor máximo do tipo é reservado.
+#if AC_MAX_VERTICES < UINT8_MAX
+typedef uint8_t ac_state_t;
+#elif AC_MAX_VERTICES < UINT16_MAX
+typedef uint16_t ac_state_t;
+#else
+typedef uint32_t ac_state_t;
+#endif
+
+#if AC_MAX_PATTERNS < UINT8_MAX
+typedef uint8_t ac_pattern_index_t;
+#elif AC_MAX_PATTERNS < UINT16_MAX
+typedef uint16_t ac_pattern_index_t;
+#else
+typedef uint32_t ac_pattern_index_t;
+#endif
 
-#define INVALID_VERTEX_U8 255
+// Identificador de padrão (ac_pattern_t.id). ac_add_pattern usa o índice
+// do padrão como id, então o tipo precisa comportar todos os índices: 16
+// bits no firmware, 32 quando o host aumenta AC_MAX_PATTERNS.
+#if AC_MAX_PATTERNS <= 65536
+typedef uint16_t ac_pattern_id_t;
+#else
+typedef uint32_t ac_pattern_id_t;
+#endif
+
+#define INVALID_VERTEX ((ac_state_t)-1)
+
+// Caracteres imprimíveis (32-126): no máximo essa quantidade de filhos por
+// vértice. Os demais bytes voltam a busca para o início.
+#define AC_ALPHABET_SIZE 95
+
+// Classe de armazenamento dos vetores temporários dimensionados por
+// AC_MAX_VERTICES (ac_renumber_vertices). Vazia, eles ficam na pilha; o
+// host usa static, porque com os seus limites não cabem na pilha (a função
+// deixa de ser reentrante).
+#ifndef AC_SCRATCH
+#define AC_SCRATCH
+#endif
+
+// Contadores de instrumentação (ac_stats_t) no ac_scanner_t. Com 0 o
+// scanner não tem o campo e os contadores somem do código de busca.
+#ifndef AC_ENABLE_STATS
+#define AC_ENABLE_STATS 0
+#endif
+
+// Prefiltro de bytes raros em ac_scanner_feed: com o scanner na raiz, pula
+// direto para perto do próximo byte raro dos padrões (ver ac_build_prefilter).
+#ifndef AC_ENABLE_PREFILTER
+#define AC_ENABLE_PREFILTER 1
+#endif
+
+// Palavra do motor Shift-Or (aho_shift_or.h): a soma dos tamanhos dos
+// padrões precisa caber nela. 32 no Cortex-M0, onde 64 bits custam o dobro
+// de instruções por byte.
+#ifndef AC_SHIFT_OR_WORD_BITS
+#define AC_SHIFT_OR_WORD_BITS 32
+#endif
+
+#if AC_SHIFT_OR_WORD_BITS == 64
+typedef uint64_t ac_shift_or_word_t;
+#else
+typedef uint32_t ac_shift_or_word_t;
+#endif
+
+// Estados até os quais ac_build pode usar um DFA completo (uma linha de
+// AC_ALPHABET_SIZE transições por estado, sem links de falha na busca). A
+// tabela fica dentro do ac_automaton_t: 0 no firmware, onde 160 linhas
+// ocupariam 15 KB de RAM.
+#ifndef AC_DFA_MAX_STATES
+#define AC_DFA_MAX_STATES 0
+#endif
+
+// Laço de busca executado da SRAM. A 48 MHz a flash do F0 precisa de um
+// wait state, pago em toda busca de instrução; as funções marcadas com
+// AC_RAMFUNC vão para a seção .RamFunc, que o startup copia para a RAM
+// junto com .data. Só o caminho crítico é marcado, porque cada byte de
+// código ali sai dos 8 KB de RAM (o tamanho é _eramfunc - _sramfunc, do
+// linker script). No host a marcação é vazia.
+#ifndef AC_ENABLE_RAMFUNC
+#if defined(__arm__) && !defined(__linux__)
+#define AC_ENABLE_RAMFUNC 1
+#else
+#define AC_ENABLE_RAMFUNC 0
+#endif
+#endif
+
+#if AC_ENABLE_RAMFUNC
+#define AC_RAMFUNC __attribute__((section(".RamFunc")))
+#else
+#define AC_RAMFUNC
+#endif
 
 #endif
@@ -2,38 +2,217 @@
 #define AHO_CORASICK_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
-#include "aho_queue.h"
 #include "aho_config.h"
 
-typedef void (*ac_match_callback_t)(const char* pattern, int position);
+// Padrão registrado e seus metadados, repassados ao callback a cada match.
+typedef struct {
+    const char* bytes;
+    void* user_data;
+    ac_pattern_id_t id;             // Identificador escolhido pelo chamador
+    uint8_t length;                 // Tamanho do padrão em bytes
+    uint8_t flags;                  // Livre para o chamador (categoria, severidade...)
+} ac_pattern_t;
+
+// Ocorrência de um padrão no texto. start e end são inclusivos.
+typedef struct {
+    size_t start;
+    size_t end;
+    ac_pattern_id_t pattern_id;     // Igual a pattern->id
+    const ac_pattern_t* pattern;
+} ac_match_t;
+
+// ctx é o ponteiro de contexto do scanner, repassado sem alteração.
+typedef void (*ac_match_callback_t)(const ac_match_t* match, void* ctx);
 
+// Aresta do goto congelado: as arestas de cada vértice ficam contíguas em
+// ac->transitions, na ordem da BFS.
 typedef struct {
     uint8_t character;
-    uint8_t next_vertex;
+    ac_state_t next_vertex;
 } ac_transition_t;
 
 typedef struct ac_vertex {
-    ac_transition_t transitions[AC_MAX_TRANSITIONS_PER_VERTEX];
-    uint8_t num_transitions;
-    uint8_t link;                   // Link de falha
+    union {
+        // Trie em construção (antes de ac_build): filhos em lista encadeada
+        struct {
+            ac_state_t first_child;
+            ac_state_t next_sibling;
+            uint8_t character;      // Caractere da aresta que chega neste vértice
+        } trie;
+        // Autômato congelado (após ac_build): linha CSR em ac->transitions
+        struct {
+            ac_state_t first_transition;
+            ac_state_t link;        // Link de falha
+            uint8_t num_transitions;
+        };
+    };
+    uint8_t depth;                  // Profundidade no Trie (tamanho do prefixo)
     uint8_t is_output : 1;          // Flag que indica se este estado é terminal
     uint8_t num_patterns : 7;     // Número de padrões que terminam aqui
-    uint8_t pattern_indices[AC_MAX_PATTERNS_PER_VERTEX];
+    ac_pattern_index_t pattern_indices[AC_MAX_PATTERNS_PER_VERTEX];
 } ac_vertex_t;
 
+// Tabelas do motor Shift-Or (aho_shift_or.h). O k-ésimo padrão inserido
+// ocupa os bits first_bit[k]..(bit final), e pattern_at_bit diz de qual
+// padrão é cada bit final.
+typedef struct {
+    ac_shift_or_word_t masks[AC_ALPHABET_SIZE]; // Bit em 0 onde o padrão tem o caractere
+    ac_shift_or_word_t starts;      // Primeiro bit de cada padrão
+    ac_shift_or_word_t accepts;     // Último bit de cada padrão
+    uint8_t first_bit[AC_SHIFT_OR_WORD_BITS];
+    uint8_t pattern_at_bit[AC_SHIFT_OR_WORD_BITS];
+    uint8_t bit_count;
+    uint8_t pattern_count;
+} ac_shift_or_table_t;
+
+// Representação que ac_build escolheu para a busca. O goto esparso é sempre
+// construído (perfil, layout, imagens e Teddy trabalham sobre ele); os
+// outros motores só trocam o laço de ac_scanner_feed.
+typedef enum {
+    AC_ENGINE_SPARSE,               // Arestas em CSR e links de falha
+    AC_ENGINE_DFA,                  // Tabela densa estado x caractere
+    AC_ENGINE_SHIFT_OR,             // Bit-paralelo, soma dos padrões cabe numa palavra
+    AC_ENGINE_MEMMEM                // Um único padrão: memmem acha as ocorrências
+} ac_engine_t;
+
+#define AC_RARE_BYTES_MAX 4          // Até quantos bytes raros a busca usa SWAR
+
+// Autômato compartilhável: depois de ac_build só é lido, então várias
+// threads podem buscar no mesmo objeto, cada uma com seu ac_scanner_t.
 typedef struct ac_automaton {
     ac_vertex_t vertices[AC_MAX_VERTICES];
-    uint8_t vertex_count;
-    const char* patterns[AC_MAX_PATTERNS];
-    uint8_t pattern_count;
-    aho_queue_t queue;
-    ac_match_callback_t match_callback;
+    ac_state_t vertex_count;
+    ac_transition_t transitions[AC_MAX_VERTICES - 1]; // Uma aresta por vértice não-raiz
+    ac_state_t transition_count;
+    ac_pattern_t patterns[AC_MAX_PATTERNS];
+    ac_pattern_index_t pattern_count;
+    bool is_built;
+    // Prefiltro (ac_build_prefilter): conjunto dos bytes raros escolhidos,
+    // indexado pelo caractere menos 32, e os próprios bytes quando são até
+    // AC_RARE_BYTES_MAX. rare_count 0 desliga o prefiltro.
+    const uint32_t* byte_frequencies;
+    uint8_t rare_set[12];
+    uint8_t rare_bytes[AC_RARE_BYTES_MAX];
+    uint8_t rare_count;
+    uint8_t rare_max_offset;        // Maior distância do início do padrão ao seu byte raro
+    ac_engine_t engine;
+    ac_shift_or_table_t shift_or;
+#if AC_DFA_MAX_STATES > 0
+    ac_state_t dfa[AC_DFA_MAX_STATES][AC_ALPHABET_SIZE];
+    uint8_t dfa_output[AC_DFA_MAX_STATES]; // Estado com algum padrão na cadeia de saídas
+#endif
 } ac_automaton_t;
 
-void ac_init(ac_automaton_t *ac, ac_match_callback_t callback);
+// Contadores de uma busca, acumulados desde ac_scanner_init (ou desde que
+// o chamador zerou o campo). Um "hop" é seguir um link de falha: no goto
+// (get_next_state) ou na cadeia de saídas (report_matches).
+typedef struct {
+    size_t bytes_scanned;
+    size_t goto_hits;               // Transições encontradas no goto
+    size_t transition_compares;     // Arestas comparadas em find_edge
+    size_t failure_hops;
+    size_t output_hops;
+    size_t callbacks;
+    size_t max_hops_per_byte;       // Maior soma de hops gasta num único byte
+    size_t bytes_skipped;           // Pulados pelo prefiltro, sem passar pelo goto
+} ac_stats_t;
+
+// Estado mutável de uma busca. Pode ser alimentado em pedaços: o estado do
+// autômato e a posição continuam de uma chamada de ac_scanner_feed para a
+// outra, e as posições reportadas são relativas ao início do fluxo.
+typedef struct {
+    const ac_automaton_t* ac;
+    ac_match_callback_t match_callback;
+    void* match_ctx;
+    size_t position;                // Offset do próximo byte no fluxo
+    ac_state_t state;
+    ac_shift_or_word_t shift_or_state; // Usado no lugar de state por AC_ENGINE_SHIFT_OR
+#if AC_ENABLE_STATS
+    ac_stats_t stats;
+#endif
+} ac_scanner_t;
+
+#if AC_ENABLE_STATS
+#define ac_scanner_stats(scanner) (&(scanner)->stats)
+#endif
+
+// Perfil de tráfego para treinar o layout: quantas vezes cada aresta de
+// ac->transitions foi tomada e quantas vezes cada vértice foi o estado após
+// um byte, numa amostra. Os índices valem para o layout em que o perfil foi
+// coletado.
+typedef struct {
+    uint32_t edge_hits[AC_MAX_VERTICES - 1];
+    uint32_t vertex_hits[AC_MAX_VERTICES];
+    ac_state_t state;               // Estado do fluxo de treino
+} ac_profile_t;
+
+void ac_init(ac_automaton_t *ac);
 bool ac_add_pattern(ac_automaton_t *ac, const char* pattern);
+bool ac_add_pattern_ex(ac_automaton_t *ac, const char* bytes, size_t len,
+                       ac_pattern_id_t id, uint8_t flags, void* user_data);
 void ac_build(ac_automaton_t *ac);
-void ac_search(ac_automaton_t *ac, const char* text);
+// Alternativa a ac_add_pattern em laço para listas já ordenadas: constrói o
+// Trie numa única passada, sem procurar filhos (detalhes no .c).
+bool ac_add_sorted_patterns(ac_automaton_t *ac, const ac_pattern_t *patterns, size_t n);
+bool ac_build_from_sorted(ac_automaton_t *ac, const ac_pattern_t *patterns, size_t n);
+
+// ac_build em duas etapas, para quem quer dividir os links entre threads
+// (Host/Src/ac_builder.c). Depois de ac_build_goto, ac_bfs_vertex(ac, i) é
+// o i-ésimo vértice da BFS e os níveis do Trie são faixas contíguas de i.
+// ac_build_links precisa ter cobrido todos os níveis mais rasos antes de
+// processar um nível; no fim, o chamador marca ac->is_built. Entre as
+// etapas o autômato não aceita padrões nem buscas.
+void ac_build_goto(ac_automaton_t *ac);
+void ac_build_links(ac_automaton_t *ac, ac_state_t first, ac_state_t last);
+
+#define ac_bfs_vertex(ac, i) ((i) == 0 ? 0 : (ac)->transitions[(i) - 1].next_vertex)
+
+// Frequência de cada valor de byte (256 contadores) usada para escolher o
+// byte raro de cada padrão. NULL volta à tabela embutida, aproximada para
+// payloads HTTP. A tabela não é copiada e precisa valer até o ac_build (ou
+// até o próximo ac_build_prefilter).
+void ac_set_byte_frequencies(ac_automaton_t *ac, const uint32_t *freq);
+// Soma a freq as ocorrências de cada byte de data, para treinar a tabela
+// sobre uma amostra do tráfego.
+void ac_count_bytes(uint32_t freq[256], const char* data, size_t len);
+// Escolhe o byte mais raro de cada padrão e monta o conjunto usado pelo
+// prefiltro. ac_build já chama; só é preciso chamar de novo depois de trocar
+// a tabela de frequências ou ao montar o autômato por outro caminho
+// (ac_build_parallel, imagens carregadas).
+void ac_build_prefilter(ac_automaton_t *ac);
+
+// Escolhe o motor de busca pelo número e tamanho dos padrões, pelos
+// caracteres usados e pelos limites de memória (AC_SHIFT_OR_WORD_BITS,
+// AC_DFA_MAX_STATES), e monta as suas tabelas. Como ac_build_prefilter:
+// ac_build já chama, os outros caminhos de construção chamam depois dele.
+void ac_select_engine(ac_automaton_t *ac);
+ac_engine_t ac_engine(const ac_automaton_t *ac);
+const char* ac_engine_name(ac_engine_t engine);
+
+void ac_search(const ac_automaton_t *ac, const char* text,
+               ac_match_callback_t callback, void* ctx);
+
+void ac_scanner_init(ac_scanner_t *scanner, const ac_automaton_t *ac,
+                     ac_match_callback_t callback, void* ctx);
+void ac_scanner_reset(ac_scanner_t *scanner);
+void ac_scanner_feed(ac_scanner_t *scanner, const char* data, size_t len);
+// Avança n bytes sem examiná-los. Só é exato com o scanner na raiz e sem
+// nenhum padrão começando nesses bytes, que é o que um prefiltro garante.
+void ac_scanner_skip(ac_scanner_t *scanner, size_t n);
+#define ac_scanner_at_root(scanner) \
+    ((scanner)->state == 0 && (scanner)->shift_or_state == (ac_shift_or_word_t)~(ac_shift_or_word_t)0)
+
+void ac_profile_init(ac_profile_t *profile);
+void ac_profile_feed(ac_profile_t *profile, const ac_automaton_t *ac, const char* data, size_t len);
+// Ordena as arestas de cada vértice da mais para a menos tomada no perfil.
+// Depois disso edge_hits não corresponde mais ao layout (vertex_hits sim).
+void ac_reorder_transitions(ac_automaton_t *ac, const ac_profile_t *profile);
+// Renumera os vértices do mais para o menos visitado, sempre depois do pai,
+// e reescreve links e arestas. Os estados quentes ficam no começo de
+// ac->vertices, que pode ser a parte da tabela mantida em RAM. A raiz
+// continua sendo o vértice 0. Invalida o perfil inteiro.
+void ac_renumber_vertices(ac_automaton_t *ac, const ac_profile_t *profile);
 
 #endif // AHO_CORASICK_H
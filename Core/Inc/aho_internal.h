@@ -0,0 +1,25 @@
+#ifndef AHO_INTERNAL_H
+#define AHO_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aho_corasick.h"
+
+// Operações sobre o Trie em construção compartilhadas entre aho_corasick.c
+// e os construtores do host (ac_builder.c). Não fazem parte da API: não
+// validam o autômato nem a capacidade de vértices, que fica com quem chama.
+
+// Cria um vértice no início da lista de filhos de parent.
+ac_state_t ac_trie_add_child(ac_automaton_t *ac, ac_state_t parent, uint8_t char_idx);
+
+// Registra o padrão como saída do vértice em que o seu caminho termina.
+// Retorna false se o vértice ou a tabela de padrões estiverem cheios.
+bool ac_trie_add_output(ac_automaton_t *ac, ac_state_t vertex, const char* bytes, size_t len,
+                        ac_pattern_id_t id, uint8_t flags, void* user_data);
+
+// true se um padrão ainda cabe no vértice (ac_trie_add_output não falharia
+// por ele). Quem insere confere antes de criar o caminho, para uma falha
+// não deixar vértices sem saída no Trie.
+bool ac_trie_can_output(const ac_automaton_t *ac, ac_state_t vertex);
+
+#endif // AHO_INTERNAL_H
@@ -0,0 +1,65 @@
+#ifndef AHO_SHIFT_OR_H
+#define AHO_SHIFT_OR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "aho_config.h"
+#include "aho_corasick.h"
+
+// Motor bit-paralelo (Shift-Or) para conjuntos pequenos: os padrões são
+// concatenados numa palavra de AC_SHIFT_OR_WORD_BITS bits, um bit por
+// caractere válido. O bit de uma posição fica em 0 enquanto o texto lido
+// termina com o prefixo do padrão até ali; cada byte custa uma consulta à
+// tabela, um deslocamento e um OR, sem tabela de estados. Aceita as mesmas
+// entradas de ac_add_pattern (caracteres fora de 32-126 são ignorados no
+// padrão e voltam o texto ao início) e chama o callback com os mesmos
+// ac_match_t. Numa mesma posição final, os matches saem na ordem de
+// inserção, não na do autômato.
+//
+// As tabelas (ac_shift_or_table_t, em aho_corasick.h) não guardam os
+// metadados dos padrões, para que o autômato as use com o seu próprio
+// vetor de padrões quando ac_build escolhe este motor.
+
+typedef struct {
+    ac_shift_or_table_t table;
+    ac_pattern_t patterns[AC_SHIFT_OR_WORD_BITS];
+} ac_shift_or_t;
+
+// Mesmo papel de ac_scanner_t: o fluxo pode ser entregue em pedaços.
+typedef struct {
+    const ac_shift_or_t* so;
+    ac_match_callback_t match_callback;
+    void* match_ctx;
+    size_t position;
+    ac_shift_or_word_t state;
+} ac_shift_or_scanner_t;
+
+void ac_shift_or_init(ac_shift_or_t *so);
+// Retornam false se o padrão não couber nos bits restantes ou não tiver
+// nenhum caractere válido.
+bool ac_shift_or_add_pattern(ac_shift_or_t *so, const char* pattern);
+bool ac_shift_or_add_pattern_ex(ac_shift_or_t *so, const char* bytes, size_t len,
+                                ac_pattern_id_t id, uint8_t flags, void* user_data);
+
+void ac_shift_or_search(const ac_shift_or_t *so, const char* text,
+                        ac_match_callback_t callback, void* ctx);
+
+void ac_shift_or_scanner_init(ac_shift_or_scanner_t *scanner, const ac_shift_or_t *so,
+                              ac_match_callback_t callback, void* ctx);
+void ac_shift_or_scanner_reset(ac_shift_or_scanner_t *scanner);
+void ac_shift_or_feed(ac_shift_or_scanner_t *scanner, const char* data, size_t len);
+
+// Núcleo usado pelas duas interfaces. O padrão k da tabela (k-ésimo
+// inserido) é reportado como patterns[k]; *state é o estado do fluxo e
+// position o offset de data[0] nele.
+#define AC_SHIFT_OR_IDLE ((ac_shift_or_word_t)~(ac_shift_or_word_t)0) // Nenhum prefixo ativo
+
+void ac_shift_or_table_init(ac_shift_or_table_t *table);
+bool ac_shift_or_table_add(ac_shift_or_table_t *table, const char* bytes, size_t len);
+void ac_shift_or_table_scan(const ac_shift_or_table_t *table, const ac_pattern_t *patterns,
+                            ac_shift_or_word_t *state, size_t position,
+                            const char* data, size_t len,
+                            ac_match_callback_t callback, void* ctx);
+
+#endif // AHO_SHIFT_OR_H
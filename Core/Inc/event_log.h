@@ -0,0 +1,60 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Registro binário de ocorrências. O callback de match só grava um
+// registro de tamanho fixo no anel; a formatação em texto fica para o
+// laço ocioso, ou nem acontece quando os registros vão crus para uma
+// ferramenta no host.
+//
+// O anel tem um produtor e um consumidor: cada índice só é escrito por um
+// lado, então o produtor pode estar numa interrupção sem trava.
+
+#ifndef EVENT_LOG_CAPACITY
+#define EVENT_LOG_CAPACITY 32       // Potência de 2
+#endif
+
+// Quando 1 os registros saem pela UART como quadros binários em vez de
+// texto (ver event_log_frame_t)
+#ifndef EVENT_LOG_BINARY
+#define EVENT_LOG_BINARY 0
+#endif
+
+#define EVENT_PACKET_STREAM 0xFFFFu // packet_id do tráfego da UART
+
+typedef struct {
+    uint32_t timestamp;             // HAL_GetTick no momento do match
+    uint32_t position;              // Primeiro byte do match no pacote/fluxo
+    uint16_t packet_id;
+    uint16_t pattern_id;
+} event_record_t;
+
+// Quadro binário: sync seguido do registro em little-endian (ordem nativa
+// do Cortex-M0)
+#define EVENT_FRAME_SYNC0 0xA5
+#define EVENT_FRAME_SYNC1 0x5A
+
+typedef struct {
+    uint8_t sync[2];
+    uint8_t record[sizeof(event_record_t)];
+} event_log_frame_t;
+
+void event_log_init(void);
+
+// Lado produtor. Retorna false (e conta o descarte) com o anel cheio.
+bool event_log_push(uint32_t timestamp, uint32_t position,
+                    uint16_t packet_id, uint16_t pattern_id);
+
+// Lado consumidor. Retorna false com o anel vazio.
+bool event_log_pop(event_record_t* record);
+
+// Monta o quadro binário de um registro
+void event_log_frame(const event_record_t* record, event_log_frame_t* frame);
+
+size_t event_log_count(void);
+uint32_t event_log_dropped(void);
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,48 @@
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "main.h"
+
+// Log não bloqueante pela UART. As mensagens são copiadas para um buffer
+// circular e o DMA de transmissão o esvazia em segundo plano: quem loga
+// volta logo, e a busca continua enquanto a linha serial transmite. Se
+// uma mensagem não cabe no espaço livre ela é descartada inteira e
+// contada, em vez de esperar a UART.
+//
+// As funções de escrita são para o contexto do laço principal (os
+// callbacks de match rodam nele); só uart_log_tx_complete e
+// uart_log_error são chamadas de interrupção.
+
+#ifndef UART_LOG_BUFFER_SIZE
+#define UART_LOG_BUFFER_SIZE 1024   // ~90 ms de texto a 115200 baud
+#endif
+
+#define UART_LOG_LINE_MAX 128       // Limite de uma mensagem formatada
+
+void uart_log_init(UART_HandleTypeDef* huart);
+
+// Enfileira len bytes. Retorna false (e conta o descarte) se não houver
+// espaço para a mensagem inteira.
+bool uart_log_write(const char* data, size_t len);
+bool uart_log_puts(const char* text);
+bool uart_log_printf(const char* format, ...)
+    __attribute__((format(printf, 1, 2)));
+
+// Bytes ainda não transmitidos
+size_t uart_log_pending(void);
+
+// Espera o buffer esvaziar (antes de um reset ou de trocar o clock)
+void uart_log_flush(void);
+
+// Mensagens e bytes descartados por falta de espaço desde o início
+uint32_t uart_log_dropped_messages(void);
+uint32_t uart_log_dropped_bytes(void);
+
+// Ganchos para HAL_UART_TxCpltCallback e HAL_UART_ErrorCallback
+void uart_log_tx_complete(UART_HandleTypeDef* huart);
+void uart_log_error(UART_HandleTypeDef* huart);
+
+#endif // UART_LOG_H
@@ -1,161 +1,928 @@
+#define _GNU_SOURCE // memmem
 #include "aho_corasick.h"
+#include "aho_internal.h"
+#include "aho_shift_or.h"
 #include <string.h> 
 
 // O vértice 0 é sempre a raiz do Trie.
-static const uint8_t ROOT_VERTEX = 0;
+static const ac_state_t ROOT_VERTEX = 0;
+
+#if AC_ENABLE_STATS
+#define AC_STAT(stmt) do { stmt; } while (0)
+#else
+#define AC_STAT(stmt) do { } while (0)
+#endif
 
 // Converte um caractere para um índice no alfabeto (0-25).
 // Retorna -1 se o caractere for inválido. A busca é case-insensitive.
-static int char_to_index(char c) {
+AC_RAMFUNC static int char_to_index(char c) {
     if (c >= 32 && c <= 126) {  
         return c - 32;
     }
     return -1;
 }
 
-static uint8_t find_transition(const ac_vertex_t *v, uint8_t char_idx);
-static uint8_t get_next_state(ac_automaton_t *ac, uint8_t current_state, uint8_t char_idx);
-static void report_matches(ac_automaton_t *ac, uint8_t state, int text_pos);
+// Frequência relativa aproximada de cada caractere imprimível em payloads
+// HTTP (texto, URLs, cabeçalhos), indexada como char_to_index. Só a ordem
+// importa: serve para escolher o byte mais raro de cada padrão.
+static const uint16_t DEFAULT_BYTE_FREQUENCIES[AC_ALPHABET_SIZE] = {
+    350,   6,  30,   8,   4,  25,  30,   5,  10,  10,   6,  12,  30,  60, 120, 150, //   ! " # $ % & ' ( ) * + , - . /
+     80,  80,  70,  60,  50,  50,  45,  40,  45,  40,  60,  25,   4,  70,   4,  15, // 0 - 9 : ; < = > ?
+      5,  40,  15,  30,  20,  30,  15,  15,  25,  15,   5,   8,  15,  15,  15,  15, // @ A - O
+     20,   3,  15,  25,  40,  15,   8,  10,   8,   5,   3,   3,   2,   3,   2,  20, // P - Z [ \ ] ^ _
+      1, 280,  60, 150, 120, 380,  70,  80, 110, 240,  15,  40, 160, 100, 220, 250, // ` a - o
+    110,  10, 220, 230, 300, 110,  50,  70,  30,  50,  10,   3,   1,   3,   3,      // p - z { | } ~
+};
 
-void ac_init(ac_automaton_t *ac, ac_match_callback_t callback) {
-    if (!ac) return;
+// Bytes entregues ao motor de cada vez enquanto o prefiltro está ativo,
+// antes de testar de novo se o scanner voltou para a raiz.
+#define VERIFY_BLOCK 16
 
-    memset(ac, 0, sizeof(ac_automaton_t));
-    ac->match_callback = callback;
-    aho_queue_init(&ac->queue);
+// Palavra com todos os bytes iguais a 0x01 / 0x80, para a busca SWAR.
+#define SWAR_ONES ((uintptr_t)-1 / 0xff)
+#define SWAR_HIGHS (SWAR_ONES * 0x80)
 
+static ac_state_t find_child(const ac_automaton_t *ac, ac_state_t vertex, uint8_t char_idx);
+static ac_state_t find_path(const ac_automaton_t *ac, const char* bytes, size_t len);
+static int next_char_index(const char* bytes, size_t len, size_t *pos);
+static ac_state_t find_edge(const ac_automaton_t *ac, const ac_vertex_t *v, uint8_t char_idx);
+static ac_state_t get_next_state(const ac_automaton_t *ac, ac_state_t current_state, uint8_t char_idx,
+                                 ac_stats_t *stats);
+static void scan_char(ac_scanner_t *scanner, char c);
+static void scan_block(ac_scanner_t *scanner, const char* data, size_t len);
+#if AC_DFA_MAX_STATES > 0
+static void scan_block_dfa(ac_scanner_t *scanner, const char* data, size_t len);
+static void build_dfa(ac_automaton_t *ac);
+#endif
+static bool build_shift_or(ac_automaton_t *ac);
+static size_t find_candidate(const ac_automaton_t *ac, const char* data, size_t from, size_t len);
+static uint32_t byte_weight(const ac_automaton_t *ac, uint8_t char_idx);
+static bool is_rare(const ac_automaton_t *ac, char c);
+static size_t find_rare(const ac_automaton_t *ac, const char* data, size_t from, size_t len);
+static size_t find_rare_swar(const ac_automaton_t *ac, const char* data, size_t from, size_t len);
+static bool is_hotter(const ac_automaton_t *ac, const ac_profile_t *profile, ac_state_t a, ac_state_t b);
+static void heap_push(const ac_automaton_t *ac, const ac_profile_t *profile,
+                      ac_state_t *heap, ac_state_t *size, ac_state_t vertex);
+static ac_state_t heap_pop(const ac_automaton_t *ac, const ac_profile_t *profile,
+                           ac_state_t *heap, ac_state_t *size);
+static void report_matches(ac_scanner_t *scanner, size_t text_pos);
+
+void ac_init(ac_automaton_t *ac) {
+    if (!ac) return;
+
+    // Só o cabeçalho e a raiz: vértices e padrões são preenchidos ao serem
+    // alocados, e com os limites do host a estrutura inteira tem centenas de MB.
     ac->vertex_count = 1;
-    ac->vertices[ROOT_VERTEX].link = ROOT_VERTEX;
+    ac->transition_count = 0;
+    ac->pattern_count = 0;
+    ac->is_built = false;
+    ac->byte_frequencies = NULL;
+    ac->rare_count = 0;
+    ac->rare_max_offset = 0;
+    ac->engine = AC_ENGINE_SPARSE;
+    memset(&ac->vertices[ROOT_VERTEX], 0, sizeof(ac_vertex_t));
+    ac->vertices[ROOT_VERTEX].trie.first_child = INVALID_VERTEX;
+    ac->vertices[ROOT_VERTEX].trie.next_sibling = INVALID_VERTEX;
 }
 
-// Adiciona um padrão ao Trie
+// Adiciona um padrão ao Trie. O id é o próprio índice do padrão.
 bool ac_add_pattern(ac_automaton_t *ac, const char* pattern) {
-    if (!ac || !pattern || *pattern == '\0' || ac->pattern_count >= AC_MAX_PATTERNS) {
+    if (!ac || !pattern) {
+        return false;
+    }
+    return ac_add_pattern_ex(ac, pattern, strlen(pattern), ac->pattern_count, 0, NULL);
+}
+
+// Adiciona um padrão de len bytes (não precisa terminar em '\0') com seus
+// metadados. Os bytes não são copiados e devem continuar válidos.
+bool ac_add_pattern_ex(ac_automaton_t *ac, const char* bytes, size_t len,
+                       ac_pattern_id_t id, uint8_t flags, void* user_data) {
+    if (!ac || ac->is_built || !bytes || len == 0 || len > UINT8_MAX
+        || ac->pattern_count >= AC_MAX_PATTERNS) {
         return false;
     }
 
-    uint8_t current_vertex = ROOT_VERTEX;
-    int pattern_len = strlen(pattern);
+    ac_state_t current_vertex = ROOT_VERTEX;
 
-    // Verifica se há espaço para os novos vértices
-    if (ac->vertex_count + pattern_len > AC_MAX_VERTICES) {
+    // Verifica se há espaço para os novos vértices e, se o caminho já
+    // existe, para mais uma saída no seu fim
+    if (ac->vertex_count + len > AC_MAX_VERTICES) {
+        return false;
+    }
+    ac_state_t existing = find_path(ac, bytes, len);
+    if (existing != INVALID_VERTEX && !ac_trie_can_output(ac, existing)) {
         return false;
     }
 
     // Adiciona o caminho do padrão no Trie
-    for (int i = 0; i < pattern_len; ++i) {
-        int char_idx = char_to_index(pattern[i]);
+    for (size_t i = 0; i < len; ++i) {
+        int char_idx = char_to_index(bytes[i]);
         if (char_idx == -1) continue; // Ignora caracteres inválidos
 
-        uint8_t next_vertex = find_transition(&ac->vertices[current_vertex], (uint8_t)char_idx);
-
-        if (next_vertex == INVALID_VERTEX_U8) {
-            next_vertex = ac->vertex_count++;
-            if (next_vertex >= AC_MAX_VERTICES) return false; // Segurança
-
-            memset(&ac->vertices[next_vertex], 0, sizeof(ac_vertex_t));
-            ac->vertices[next_vertex].link = INVALID_VERTEX_U8;
+        ac_state_t next_vertex = find_child(ac, current_vertex, (uint8_t)char_idx);
 
-            ac_vertex_t *v = &ac->vertices[current_vertex];
-            if (v->num_transitions < AC_MAX_TRANSITIONS_PER_VERTEX) {
-                v->transitions[v->num_transitions].character = (uint8_t)char_idx;
-                v->transitions[v->num_transitions].next_vertex = next_vertex;
-                v->num_transitions++;
-            } else {
-                 return false;
-            }
+        if (next_vertex == INVALID_VERTEX) {
+            next_vertex = ac_trie_add_child(ac, current_vertex, (uint8_t)char_idx);
         }
         current_vertex = next_vertex;
     }
 
-    ac_vertex_t *v = &ac->vertices[current_vertex];
-    if (v->num_patterns < AC_MAX_PATTERNS_PER_VERTEX) {
-        v->is_output = true;
-        ac->patterns[ac->pattern_count] = pattern;
-        v->pattern_indices[v->num_patterns++] = ac->pattern_count++;
-    } else {
+    return ac_trie_add_output(ac, current_vertex, bytes, len, id, flags, user_data);
+}
+
+// Insere padrões já ordenados pelos seus caracteres válidos (ordem de
+// memcmp, prefixo antes do padrão mais longo; repetidos são aceitos). Cada
+// padrão compartilha com o anterior o maior prefixo comum, então basta
+// voltar na pilha do caminho anterior e criar o resto, sem procurar
+// filhos: tempo linear no total de bytes, e os vértices saem em pré-ordem
+// (DFS). O autômato precisa estar vazio (recém ac_init). Retorna false se
+// a lista estiver fora de ordem ou não couber; o Trie fica com os padrões
+// anteriores ao que falhou.
+bool ac_add_sorted_patterns(ac_automaton_t *ac, const ac_pattern_t *patterns, size_t n) {
+    if (!ac || ac->is_built || !patterns || ac->vertex_count != 1 || ac->pattern_count != 0) {
         return false;
     }
 
+    ac_state_t path[UINT8_MAX + 1]; // path[d]: vértice de profundidade d do último padrão
+    path[0] = ROOT_VERTEX;
+    const ac_pattern_t *prev = NULL;
+
+    for (size_t i = 0; i < n; ++i) {
+        const ac_pattern_t *p = &patterns[i];
+        if (!p->bytes || p->length == 0) return false;
+
+        size_t pos = 0, prev_pos = 0;
+        uint8_t depth = 0;
+        int c = next_char_index(p->bytes, p->length, &pos);
+        if (prev) {
+            int prev_c = next_char_index(prev->bytes, prev->length, &prev_pos);
+            while (c != -1 && c == prev_c) {
+                depth++;
+                c = next_char_index(p->bytes, p->length, &pos);
+                prev_c = next_char_index(prev->bytes, prev->length, &prev_pos);
+            }
+            if (prev_c != -1 && (c == -1 || c < prev_c)) return false; // Fora de ordem
+        }
+
+        while (c != -1) {
+            if (ac->vertex_count >= AC_MAX_VERTICES) return false;
+            path[depth + 1] = ac_trie_add_child(ac, path[depth], (uint8_t)c);
+            depth++;
+            c = next_char_index(p->bytes, p->length, &pos);
+        }
+
+        if (!ac_trie_add_output(ac, path[depth], p->bytes, p->length, p->id, p->flags, p->user_data)) {
+            return false;
+        }
+        prev = p;
+    }
+    return true;
+}
+
+// ac_init + ac_add_sorted_patterns + ac_build.
+bool ac_build_from_sorted(ac_automaton_t *ac, const ac_pattern_t *patterns, size_t n) {
+    if (!ac) return false;
+
+    ac_init(ac);
+    if (!ac_add_sorted_patterns(ac, patterns, n)) return false;
+    ac_build(ac);
     return true;
 }
 
+// Congela o goto e calcula os links de falha sobre a mesma ordem de BFS.
 void ac_build(ac_automaton_t *ac) {
-    if (!ac || ac->vertex_count <= 1) return;
+    if (!ac || ac->is_built) return;
 
-    aho_queue_init(&ac->queue);
-    ac_vertex_t *root = &ac->vertices[ROOT_VERTEX];
+    ac_build_goto(ac);
+    ac_build_links(ac, 0, ac->vertex_count);
+    ac_build_prefilter(ac);
+    ac_select_engine(ac);
+    ac->is_built = true;
+}
 
-    for (uint8_t i = 0; i < root->num_transitions; ++i) {
-        uint8_t child_idx = root->transitions[i].next_vertex;
-        ac->vertices[child_idx].link = ROOT_VERTEX;
-        aho_queue_enqueue(&ac->queue, child_idx);
-    }
+// Congela o goto em CSR. Ao visitar um vértice, seus filhos são copiados
+// para o fim de ac->transitions, então as arestas ficam agrupadas por
+// vértice e ordenadas pela BFS. O próprio vetor de arestas é a fila da BFS:
+// o próximo vértice a visitar é o destino da próxima aresta ainda não
+// visitada.
+void ac_build_goto(ac_automaton_t *ac) {
+    if (!ac || ac->is_built) return;
+
+    ac->transition_count = 0;
 
-    while (!aho_queue_is_empty(&ac->queue)) {
-        uint8_t current_v_idx = aho_queue_dequeue(&ac->queue);
+    for (ac_state_t visited = 0; visited < ac->vertex_count; ++visited) {
+        ac_state_t current_v_idx = ac_bfs_vertex(ac, visited);
         ac_vertex_t *current_v = &ac->vertices[current_v_idx];
 
-        for (uint8_t i = 0; i < current_v->num_transitions; ++i) {
-            uint8_t char_idx = current_v->transitions[i].character;
-            uint8_t child_idx = current_v->transitions[i].next_vertex;
+        ac_state_t first = ac->transition_count;
+        ac_state_t child_idx = current_v->trie.first_child;
+        while (child_idx != INVALID_VERTEX) {
+            ac_vertex_t *child = &ac->vertices[child_idx];
+            ac_transition_t *t = &ac->transitions[ac->transition_count++];
+            t->character = child->trie.character;
+            t->next_vertex = child_idx;
+            child_idx = child->trie.next_sibling;
+        }
+
+        current_v->first_transition = first;
+        current_v->num_transitions = ac->transition_count - first;
+    }
+    ac->vertices[ROOT_VERTEX].link = ROOT_VERTEX;
+}
+
+// Define os links dos filhos dos vértices nas posições [first, last) da BFS.
+// O link de um filho só consulta vértices mais rasos, então basta que os
+// níveis anteriores tenham sido processados; vértices do mesmo nível não
+// dependem uns dos outros.
+void ac_build_links(ac_automaton_t *ac, ac_state_t first, ac_state_t last) {
+    if (!ac) return;
+
+    for (ac_state_t visited = first; visited < last; ++visited) {
+        ac_state_t v_idx = ac_bfs_vertex(ac, visited);
+        const ac_vertex_t *v = &ac->vertices[v_idx];
+
+        for (uint8_t i = 0; i < v->num_transitions; ++i) {
+            const ac_transition_t *t = &ac->transitions[v->first_transition + i];
+            ac_state_t next_link = ROOT_VERTEX;
+            if (v_idx != ROOT_VERTEX) {
+                next_link = get_next_state(ac, v->link, t->character, NULL);
+            }
+            ac->vertices[t->next_vertex].link = next_link;
+        }
+    }
+}
+
+void ac_set_byte_frequencies(ac_automaton_t *ac, const uint32_t *freq) {
+    if (!ac) return;
+
+    ac->byte_frequencies = freq;
+}
+
+void ac_count_bytes(uint32_t freq[256], const char* data, size_t len) {
+    if (!freq || !data) return;
+
+    for (size_t i = 0; i < len; ++i) {
+        freq[(uint8_t)data[i]]++;
+    }
+}
+
+// O byte raro de um padrão é o seu caractere válido de menor frequência (o
+// primeiro, em caso de empate). Todo match tem esse byte a uma distância
+// fixa do início, então o prefiltro só precisa achar o próximo byte do
+// conjunto e recuar rare_max_offset. O prefiltro fica desligado se algum
+// padrão não tiver caractere válido ou se o conjunto, somado, não for raro
+// (mais de 1/4 do tráfego), porque aí quase nada seria pulado.
+void ac_build_prefilter(ac_automaton_t *ac) {
+    if (!ac) return;
+
+    memset(ac->rare_set, 0, sizeof(ac->rare_set));
+    ac->rare_count = 0;
+    ac->rare_max_offset = 0;
+
+    uint64_t total_weight = 0, rare_weight = 0;
+    for (uint8_t c = 0; c < AC_ALPHABET_SIZE; ++c) {
+        total_weight += byte_weight(ac, c);
+    }
+
+    uint8_t count = 0, max_offset = 0;
+    for (ac_pattern_index_t i = 0; i < ac->pattern_count; ++i) {
+        const ac_pattern_t *p = &ac->patterns[i];
+        size_t pos = 0;
+        uint8_t offset = 0, best_offset = 0;
+        int best = -1;
+        int c;
+        while ((c = next_char_index(p->bytes, p->length, &pos)) != -1) {
+            if (best == -1 || byte_weight(ac, (uint8_t)c) < byte_weight(ac, (uint8_t)best)) {
+                best = c;
+                best_offset = offset;
+            }
+            offset++;
+        }
+        if (best == -1) return;
+
+        if (!(ac->rare_set[best >> 3] & (1u << (best & 7)))) {
+            ac->rare_set[best >> 3] |= (uint8_t)(1u << (best & 7));
+            if (count < AC_RARE_BYTES_MAX) {
+                ac->rare_bytes[count] = (uint8_t)(best + 32);
+            }
+            count++;
+            rare_weight += byte_weight(ac, (uint8_t)best);
+        }
+        if (best_offset > max_offset) {
+            max_offset = best_offset;
+        }
+    }
+
+    if (count == 0 || rare_weight * 4 > total_weight) return;
+    ac->rare_count = count;
+    ac->rare_max_offset = max_offset;
+}
+
+// Do mais para o menos rápido entre os que cabem. O DFA entra depois do
+// Shift-Or porque cada estado custa uma linha inteira de transições.
+void ac_select_engine(ac_automaton_t *ac) {
+    if (!ac) return;
+
+    ac->engine = AC_ENGINE_SPARSE;
+    if (ac->pattern_count == 0) return;
+
+    // Com um só padrão e sem caracteres ignorados, o padrão no texto é
+    // exatamente os seus bytes
+    const ac_pattern_t *first = &ac->patterns[0];
+    if (ac->pattern_count == 1 && ac->vertex_count - 1u == first->length) {
+        ac->engine = AC_ENGINE_MEMMEM;
+        return;
+    }
+
+    if (build_shift_or(ac)) {
+        ac->engine = AC_ENGINE_SHIFT_OR;
+        return;
+    }
+
+#if AC_DFA_MAX_STATES > 0
+    if (ac->vertex_count <= AC_DFA_MAX_STATES) {
+        build_dfa(ac);
+        ac->engine = AC_ENGINE_DFA;
+    }
+#endif
+}
+
+ac_engine_t ac_engine(const ac_automaton_t *ac) {
+    return ac ? ac->engine : AC_ENGINE_SPARSE;
+}
+
+const char* ac_engine_name(ac_engine_t engine) {
+    switch (engine) {
+        case AC_ENGINE_SPARSE: return "sparse";
+        case AC_ENGINE_DFA: return "dfa";
+        case AC_ENGINE_SHIFT_OR: return "shift_or";
+        case AC_ENGINE_MEMMEM: return "memmem";
+    }
+    return "unknown";
+}
+
+// Busca em um texto terminado em '\0', com um scanner temporário na pilha.
+void ac_search(const ac_automaton_t *ac, const char* text,
+               ac_match_callback_t callback, void* ctx) {
+    if (!ac || !text || !ac->is_built || ac->pattern_count == 0) return;
+
+    ac_scanner_t scanner;
+    ac_scanner_init(&scanner, ac, callback, ctx);
+    ac_scanner_feed(&scanner, text, strlen(text));
+}
+
+void ac_scanner_init(ac_scanner_t *scanner, const ac_automaton_t *ac,
+                     ac_match_callback_t callback, void* ctx) {
+    if (!scanner) return;
+
+    scanner->ac = ac;
+    scanner->match_callback = callback;
+    scanner->match_ctx = ctx;
+    AC_STAT(memset(&scanner->stats, 0, sizeof(scanner->stats)));
+    ac_scanner_reset(scanner);
+}
+
+// Volta ao início do fluxo: estado na raiz e posição zero.
+void ac_scanner_reset(ac_scanner_t *scanner) {
+    if (!scanner) return;
+
+    scanner->position = 0;
+    scanner->state = ROOT_VERTEX;
+    scanner->shift_or_state = AC_SHIFT_OR_IDLE;
+}
+
+AC_RAMFUNC void ac_scanner_feed(ac_scanner_t *scanner, const char* data, size_t len) {
+    if (!scanner || !scanner->ac || !data || !scanner->ac->is_built) return;
+    if (scanner->ac->pattern_count == 0) {
+        scanner->position += len;
+        AC_STAT(scanner->stats.bytes_scanned += len);
+        return;
+    }
+
+    const ac_automaton_t *ac = scanner->ac;
+    bool prefilter = ac->engine == AC_ENGINE_MEMMEM;
+#if AC_ENABLE_PREFILTER
+    prefilter = prefilter || ac->rare_count > 0;
+#endif
+    if (!prefilter) {
+        scan_block(scanner, data, len);
+        return;
+    }
 
-            ac->vertices[child_idx].link = get_next_state(ac, current_v->link, char_idx);
-            aho_queue_enqueue(&ac->queue, child_idx);
+    // Na raiz, todo match futuro começa em i ou depois. find_candidate diz
+    // onde está o primeiro que pode começar; antes dele os bytes são
+    // pulados sem passar pelo motor.
+    size_t candidate = 0;
+    bool candidate_known = false;
+    size_t i = 0;
+    while (i < len) {
+        if (ac_scanner_at_root(scanner)) {
+            if (!candidate_known || candidate < i) {
+                candidate = find_candidate(ac, data, i, len);
+                candidate_known = true;
+            }
+            if (candidate > i) {
+                ac_scanner_skip(scanner, candidate - i);
+                AC_STAT(scanner->stats.bytes_skipped += candidate - i);
+                i = candidate;
+                if (i == len) break;
+            }
         }
+
+        size_t n = (len - i < VERIFY_BLOCK) ? len - i : VERIFY_BLOCK;
+        scan_block(scanner, data + i, n);
+        i += n;
     }
 }
 
-void ac_search(ac_automaton_t *ac, const char* text) {
-    if (!ac || !text || ac->pattern_count == 0) return;
+AC_RAMFUNC void ac_scanner_skip(ac_scanner_t *scanner, size_t n) {
+    if (!scanner) return;
+
+    scanner->position += n;
+}
+
+void ac_profile_init(ac_profile_t *profile) {
+    if (!profile) return;
+
+    memset(profile, 0, sizeof(ac_profile_t));
+    profile->state = ROOT_VERTEX;
+}
+
+// Treino: refaz a busca sobre uma amostra contando cada aresta tomada. As
+// consultas que falham comparam todas as arestas do vértice em qualquer
+// ordem, então só as que acertam importam.
+void ac_profile_feed(ac_profile_t *profile, const ac_automaton_t *ac, const char* data, size_t len) {
+    if (!profile || !ac || !data || !ac->is_built) return;
 
-    uint8_t current_state = ROOT_VERTEX;
-    for (int i = 0; text[i] != '\0'; ++i) {
-        int char_idx = char_to_index(text[i]);
+    ac_state_t state = profile->state;
+    for (size_t i = 0; i < len; ++i) {
+        int char_idx = char_to_index(data[i]);
         if (char_idx == -1) {
-            current_state = ROOT_VERTEX;
+            state = ROOT_VERTEX;
             continue;
         }
 
-        current_state = get_next_state(ac, current_state, (uint8_t)char_idx);
-        report_matches(ac, current_state, i);
+        while (true) {
+            ac_state_t edge = find_edge(ac, &ac->vertices[state], (uint8_t)char_idx);
+            if (edge != INVALID_VERTEX) {
+                profile->edge_hits[edge]++;
+                state = ac->transitions[edge].next_vertex;
+                break;
+            }
+            if (state == ROOT_VERTEX) break;
+            state = ac->vertices[state].link;
+        }
+        profile->vertex_hits[state]++;
+    }
+    profile->state = state;
+}
+
+void ac_reorder_transitions(ac_automaton_t *ac, const ac_profile_t *profile) {
+    if (!ac || !profile || !ac->is_built) return;
+
+    uint8_t order[AC_ALPHABET_SIZE];
+    ac_transition_t sorted[AC_ALPHABET_SIZE];
+
+    for (ac_state_t v_idx = 0; v_idx < ac->vertex_count; ++v_idx) {
+        const ac_vertex_t *v = &ac->vertices[v_idx];
+        const uint32_t *hits = &profile->edge_hits[v->first_transition];
+        uint8_t n = v->num_transitions;
+        if (n < 2) continue;
+
+        // Insertion sort estável: empates mantêm a ordem da BFS
+        for (uint8_t i = 0; i < n; ++i) {
+            uint8_t j = i;
+            while (j > 0 && hits[order[j - 1]] < hits[i]) {
+                order[j] = order[j - 1];
+                --j;
+            }
+            order[j] = i;
+        }
+
+        for (uint8_t i = 0; i < n; ++i) {
+            sorted[i] = ac->transitions[v->first_transition + order[i]];
+        }
+        memcpy(&ac->transitions[v->first_transition], sorted, n * sizeof(ac_transition_t));
+    }
+}
+
+// Percorre o Trie a partir da raiz sempre expandindo o vértice mais quente
+// da fronteira (heap de máximo). Assim cada vértice é numerado depois do
+// pai, os estados mais visitados vêm primeiro e os frios ficam no fim em
+// ordem de profundidade. Os vetores temporários usam AC_SCRATCH.
+void ac_renumber_vertices(ac_automaton_t *ac, const ac_profile_t *profile) {
+    if (!ac || !profile || !ac->is_built) return;
+
+    AC_SCRATCH ac_state_t new_id[AC_MAX_VERTICES];
+    AC_SCRATCH ac_state_t order[AC_MAX_VERTICES]; // order[novo] = antigo; serve de heap antes
+    AC_SCRATCH ac_transition_t edges[AC_MAX_VERTICES - 1];
+    ac_state_t count = 0, heap_size = 0;
+
+    new_id[ROOT_VERTEX] = count++;
+    for (uint8_t i = 0; i < ac->vertices[ROOT_VERTEX].num_transitions; ++i) {
+        ac_state_t child = ac->transitions[ac->vertices[ROOT_VERTEX].first_transition + i].next_vertex;
+        heap_push(ac, profile, order, &heap_size, child);
+    }
+    while (heap_size > 0) {
+        ac_state_t v_idx = heap_pop(ac, profile, order, &heap_size);
+        const ac_vertex_t *v = &ac->vertices[v_idx];
+        new_id[v_idx] = count++;
+        for (uint8_t i = 0; i < v->num_transitions; ++i) {
+            heap_push(ac, profile, order, &heap_size, ac->transitions[v->first_transition + i].next_vertex);
+        }
+    }
+    for (ac_state_t v_idx = 0; v_idx < ac->vertex_count; ++v_idx) {
+        order[new_id[v_idx]] = v_idx;
+    }
+
+    // Arestas regravadas em CSR na nova ordem, apontando para os novos ids
+    memcpy(edges, ac->transitions, ac->transition_count * sizeof(ac_transition_t));
+    ac_state_t next_edge = 0;
+    for (ac_state_t n = 0; n < ac->vertex_count; ++n) {
+        ac_vertex_t *v = &ac->vertices[order[n]];
+        for (uint8_t i = 0; i < v->num_transitions; ++i) {
+            ac_transition_t t = edges[v->first_transition + i];
+            t.next_vertex = new_id[t.next_vertex];
+            ac->transitions[next_edge + i] = t;
+        }
+        v->first_transition = next_edge;
+        v->link = new_id[v->link];
+        next_edge += v->num_transitions;
+    }
+
+    // Permuta os vértices no lugar seguindo os ciclos de order; cada posição
+    // resolvida é marcada com order[n] = n.
+    for (ac_state_t start = 0; start < ac->vertex_count; ++start) {
+        if (order[start] == start) continue;
+
+        ac_vertex_t saved = ac->vertices[start];
+        ac_state_t n = start;
+        while (order[n] != start) {
+            ac_state_t from = order[n];
+            ac->vertices[n] = ac->vertices[from];
+            order[n] = n;
+            n = from;
+        }
+        ac->vertices[n] = saved;
+        order[n] = n;
+    }
+
+#if AC_DFA_MAX_STATES > 0
+    if (ac->engine == AC_ENGINE_DFA) {
+        build_dfa(ac);
+    }
+#endif
+}
+
+AC_RAMFUNC static void scan_char(ac_scanner_t *scanner, char c) {
+#if AC_ENABLE_STATS
+    ac_stats_t *stats = &scanner->stats;
+    size_t hops_before = stats->failure_hops + stats->output_hops;
+    stats->bytes_scanned++;
+#else
+    ac_stats_t *stats = NULL;
+#endif
+
+    int char_idx = char_to_index(c);
+    if (char_idx == -1) {
+        scanner->state = ROOT_VERTEX;
+    } else {
+        scanner->state = get_next_state(scanner->ac, scanner->state, (uint8_t)char_idx, stats);
+        report_matches(scanner, scanner->position);
+    }
+    scanner->position++;
+
+#if AC_ENABLE_STATS
+    size_t hops = stats->failure_hops + stats->output_hops - hops_before;
+    if (hops > stats->max_hops_per_byte) {
+        stats->max_hops_per_byte = hops;
+    }
+#endif
+}
+
+// Entrega len bytes ao motor escolhido em ac_build.
+AC_RAMFUNC static void scan_block(ac_scanner_t *scanner, const char* data, size_t len) {
+    const ac_automaton_t *ac = scanner->ac;
+
+    switch (ac->engine) {
+        case AC_ENGINE_SHIFT_OR:
+            ac_shift_or_table_scan(&ac->shift_or, ac->patterns, &scanner->shift_or_state,
+                                   scanner->position, data, len,
+                                   scanner->match_callback, scanner->match_ctx);
+            scanner->position += len;
+            AC_STAT(scanner->stats.bytes_scanned += len);
+            break;
+#if AC_DFA_MAX_STATES > 0
+        case AC_ENGINE_DFA:
+            scan_block_dfa(scanner, data, len);
+            break;
+#endif
+        default:
+            for (size_t i = 0; i < len; ++i) {
+                scan_char(scanner, data[i]);
+            }
+            break;
+    }
+}
+
+#if AC_DFA_MAX_STATES > 0
+// Uma consulta à tabela por byte; a cadeia de saídas só é percorrida nos
+// estados que têm algum padrão nela.
+static void scan_block_dfa(ac_scanner_t *scanner, const char* data, size_t len) {
+    const ac_automaton_t *ac = scanner->ac;
+    ac_state_t state = scanner->state;
+
+    for (size_t i = 0; i < len; ++i) {
+        int char_idx = char_to_index(data[i]);
+        state = (char_idx == -1) ? ROOT_VERTEX : ac->dfa[state][char_idx];
+        if (ac->dfa_output[state]) {
+            scanner->state = state;
+            report_matches(scanner, scanner->position + i);
+        }
+    }
+    scanner->state = state;
+    scanner->position += len;
+    AC_STAT(scanner->stats.bytes_scanned += len);
+}
+
+// Cada linha é o goto completado pelos links de falha, então depende dos
+// números dos vértices: é refeita depois de ac_renumber_vertices.
+static void build_dfa(ac_automaton_t *ac) {
+    for (ac_state_t v = 0; v < ac->vertex_count; ++v) {
+        for (uint8_t c = 0; c < AC_ALPHABET_SIZE; ++c) {
+            ac->dfa[v][c] = get_next_state(ac, v, c, NULL);
+        }
+
+        ac_state_t s = v;
+        ac->dfa_output[v] = 0;
+        while (s != ROOT_VERTEX && !ac->dfa_output[v]) {
+            ac->dfa_output[v] = ac->vertices[s].is_output;
+            s = ac->vertices[s].link;
+        }
+    }
+}
+#endif
+
+// Os padrões na ordem de ac->patterns, para que o k-ésimo bit final seja o
+// padrão k. false se a soma dos tamanhos não couber na palavra.
+static bool build_shift_or(ac_automaton_t *ac) {
+    ac_shift_or_table_init(&ac->shift_or);
+    for (ac_pattern_index_t i = 0; i < ac->pattern_count; ++i) {
+        const ac_pattern_t *p = &ac->patterns[i];
+        if (!ac_shift_or_table_add(&ac->shift_or, p->bytes, p->length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Primeira posição >= from em que um match pode começar, ou a partir da
+// qual ainda pode começar um que termine depois de len. Com um único padrão
+// (AC_ENGINE_MEMMEM) é a próxima ocorrência inteira; com bytes raros, o
+// próximo byte raro menos rare_max_offset, já que todo match tem o seu
+// byte raro no máximo essa distância depois do início.
+AC_RAMFUNC static size_t find_candidate(const ac_automaton_t *ac, const char* data, size_t from, size_t len) {
+    size_t hit, back;
+
+    if (ac->engine == AC_ENGINE_MEMMEM) {
+        const ac_pattern_t *p = &ac->patterns[0];
+        const char* found = memmem(data + from, len - from, p->bytes, p->length);
+        if (found) return (size_t)(found - data);
+        hit = len;
+        back = p->length - 1u;
+    } else {
+        hit = find_rare(ac, data, from, len);
+        back = ac->rare_max_offset;
+    }
+    return (hit > from + back) ? hit - back : from;
+}
+
+// Frequência de um caractere válido na tabela treinada ou na embutida.
+static uint32_t byte_weight(const ac_automaton_t *ac, uint8_t char_idx) {
+    if (ac->byte_frequencies) {
+        return ac->byte_frequencies[char_idx + 32];
+    }
+    return DEFAULT_BYTE_FREQUENCIES[char_idx];
+}
+
+AC_RAMFUNC static bool is_rare(const ac_automaton_t *ac, char c) {
+    int char_idx = char_to_index(c);
+    return char_idx != -1 && (ac->rare_set[char_idx >> 3] & (1u << (char_idx & 7)));
+}
+
+// Primeira posição >= from com um byte raro, ou len se não houver.
+AC_RAMFUNC static size_t find_rare(const ac_automaton_t *ac, const char* data, size_t from, size_t len) {
+    if (ac->rare_count == 1) {
+        const char* p = memchr(data + from, ac->rare_bytes[0], len - from);
+        return p ? (size_t)(p - data) : len;
+    }
+    if (ac->rare_count <= AC_RARE_BYTES_MAX) {
+        return find_rare_swar(ac, data, from, len);
+    }
+
+    for (size_t i = from; i < len; ++i) {
+        if (is_rare(ac, data[i])) return i;
+    }
+    return len;
+}
+
+// Testa uma palavra inteira por iteração: x = w ^ (byte repetido) tem um
+// byte zero onde w tem aquele byte, e (x - 0x01..) & ~x & 0x80.. é diferente
+// de zero exatamente quando x tem algum byte zero. A palavra que acusa é
+// refeita byte a byte para achar a posição. As leituras são alinhadas,
+// porque o Cortex-M0 não aceita acesso desalinhado a palavras.
+AC_RAMFUNC static size_t find_rare_swar(const ac_automaton_t *ac, const char* data, size_t from, size_t len) {
+    uintptr_t patterns[AC_RARE_BYTES_MAX];
+    for (uint8_t k = 0; k < ac->rare_count; ++k) {
+        patterns[k] = SWAR_ONES * ac->rare_bytes[k];
+    }
+
+    size_t i = from;
+    while (i < len && (uintptr_t)(data + i) % sizeof(uintptr_t) != 0) {
+        if (is_rare(ac, data[i])) return i;
+        i++;
+    }
+
+    for (; i + sizeof(uintptr_t) <= len; i += sizeof(uintptr_t)) {
+        uintptr_t w, found = 0;
+        memcpy(&w, __builtin_assume_aligned(data + i, sizeof(uintptr_t)), sizeof(w));
+        for (uint8_t k = 0; k < ac->rare_count; ++k) {
+            uintptr_t x = w ^ patterns[k];
+            found |= (x - SWAR_ONES) & ~x & SWAR_HIGHS;
+        }
+        if (found) break;
+    }
+
+    for (; i < len; ++i) {
+        if (is_rare(ac, data[i])) return i;
+    }
+    return len;
+}
+
+// Busca um filho no Trie ainda em construção.
+static ac_state_t find_child(const ac_automaton_t *ac, ac_state_t vertex, uint8_t char_idx) {
+    ac_state_t child = ac->vertices[vertex].trie.first_child;
+    while (child != INVALID_VERTEX) {
+        if (ac->vertices[child].trie.character == char_idx) {
+            return child;
+        }
+        child = ac->vertices[child].trie.next_sibling;
+    }
+    return INVALID_VERTEX;
+}
+
+// Vértice em que termina o caminho de bytes, ou INVALID_VERTEX se o
+// caminho ainda não existe inteiro no Trie.
+static ac_state_t find_path(const ac_automaton_t *ac, const char* bytes, size_t len) {
+    ac_state_t vertex = ROOT_VERTEX;
+    for (size_t i = 0; i < len && vertex != INVALID_VERTEX; ++i) {
+        int char_idx = char_to_index(bytes[i]);
+        if (char_idx == -1) continue;
+        vertex = find_child(ac, vertex, (uint8_t)char_idx);
+    }
+    return vertex;
+}
+
+ac_state_t ac_trie_add_child(ac_automaton_t *ac, ac_state_t parent, uint8_t char_idx) {
+    ac_state_t child_idx = ac->vertex_count++;
+    ac_vertex_t *child = &ac->vertices[child_idx];
+    memset(child, 0, sizeof(ac_vertex_t));
+    child->trie.first_child = INVALID_VERTEX;
+    child->trie.next_sibling = ac->vertices[parent].trie.first_child;
+    child->trie.character = char_idx;
+    child->depth = ac->vertices[parent].depth + 1;
+    ac->vertices[parent].trie.first_child = child_idx;
+    return child_idx;
+}
+
+bool ac_trie_can_output(const ac_automaton_t *ac, ac_state_t vertex) {
+    return ac->vertices[vertex].num_patterns < AC_MAX_PATTERNS_PER_VERTEX
+        && ac->pattern_count < AC_MAX_PATTERNS;
+}
+
+bool ac_trie_add_output(ac_automaton_t *ac, ac_state_t vertex, const char* bytes, size_t len,
+                        ac_pattern_id_t id, uint8_t flags, void* user_data) {
+    if (!ac_trie_can_output(ac, vertex)) {
+        return false;
+    }
+
+    ac_vertex_t *v = &ac->vertices[vertex];
+
+    v->is_output = true;
+    ac_pattern_t *p = &ac->patterns[ac->pattern_count];
+    p->bytes = bytes;
+    p->user_data = user_data;
+    p->id = id;
+    p->length = (uint8_t)len;
+    p->flags = flags;
+    v->pattern_indices[v->num_patterns++] = ac->pattern_count++;
+    return true;
+}
+
+// Próximo caractere válido a partir de *pos (que avança), ou -1 no fim.
+static int next_char_index(const char* bytes, size_t len, size_t *pos) {
+    while (*pos < len) {
+        int char_idx = char_to_index(bytes[(*pos)++]);
+        if (char_idx != -1) return char_idx;
     }
+    return -1;
 }
 
-static uint8_t find_transition(const ac_vertex_t *v, uint8_t char_idx) {
+// Retorna o índice da aresta em ac->transitions, ou INVALID_VERTEX.
+AC_RAMFUNC static ac_state_t find_edge(const ac_automaton_t *ac, const ac_vertex_t *v, uint8_t char_idx) {
+    const ac_transition_t *t = &ac->transitions[v->first_transition];
     for (int i = 0; i < v->num_transitions; ++i) {
-        if (v->transitions[i].character == char_idx) {
-            return v->transitions[i].next_vertex;
+        if (t[i].character == char_idx) {
+            return v->first_transition + i;
         }
     }
-    return INVALID_VERTEX_U8;
+    return INVALID_VERTEX;
 }
 
-static uint8_t get_next_state(ac_automaton_t *ac, uint8_t current_state, uint8_t char_idx) {
+
+// stats pode ser NULL (ac_build); só é usado com AC_ENABLE_STATS.
+AC_RAMFUNC static ac_state_t get_next_state(const ac_automaton_t *ac, ac_state_t current_state, uint8_t char_idx,
+                                            ac_stats_t *stats) {
+    (void)stats;
     while (true) {
-        uint8_t next = find_transition(&ac->vertices[current_state], char_idx);
-        if (next != INVALID_VERTEX_U8) {
-            return next;
+        const ac_vertex_t *v = &ac->vertices[current_state];
+        ac_state_t edge = find_edge(ac, v, char_idx);
+        if (edge != INVALID_VERTEX) {
+            AC_STAT(if (stats) {
+                stats->goto_hits++;
+                stats->transition_compares += edge - v->first_transition + 1;
+            });
+            return ac->transitions[edge].next_vertex;
         }
+        AC_STAT(if (stats) stats->transition_compares += v->num_transitions);
         if (current_state == ROOT_VERTEX) {
             return ROOT_VERTEX;
         }
         current_state = ac->vertices[current_state].link;
+        AC_STAT(if (stats) stats->failure_hops++);
+    }
+}
+
+// Mais visitado primeiro; empates vão para o mais raso e depois para o
+// menor índice, o que mantém os vértices frios em ordem de BFS.
+static bool is_hotter(const ac_automaton_t *ac, const ac_profile_t *profile, ac_state_t a, ac_state_t b) {
+    if (profile->vertex_hits[a] != profile->vertex_hits[b]) {
+        return profile->vertex_hits[a] > profile->vertex_hits[b];
+    }
+    if (ac->vertices[a].depth != ac->vertices[b].depth) {
+        return ac->vertices[a].depth < ac->vertices[b].depth;
+    }
+    return a < b;
+}
+
+static void heap_push(const ac_automaton_t *ac, const ac_profile_t *profile,
+                      ac_state_t *heap, ac_state_t *size, ac_state_t vertex) {
+    unsigned i = (*size)++;
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (!is_hotter(ac, profile, vertex, heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = vertex;
+}
+
+static ac_state_t heap_pop(const ac_automaton_t *ac, const ac_profile_t *profile,
+                           ac_state_t *heap, ac_state_t *size) {
+    ac_state_t top = heap[0];
+    ac_state_t last = heap[--(*size)];
+    unsigned i = 0;
+    while (true) {
+        unsigned child = 2 * i + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && is_hotter(ac, profile, heap[child + 1], heap[child])) child++;
+        if (!is_hotter(ac, profile, heap[child], last)) break;
+        heap[i] = heap[child];
+        i = child;
     }
+    heap[i] = last;
+    return top;
 }
 
-static void report_matches(ac_automaton_t *ac, uint8_t state, int text_pos) {
-    if (!ac->match_callback) return;
+AC_RAMFUNC static void report_matches(ac_scanner_t *scanner, size_t text_pos) {
+    if (!scanner->match_callback) return;
 
-    uint8_t current_state = state;
+    const ac_automaton_t *ac = scanner->ac;
+    ac_state_t current_state = scanner->state;
     while (current_state != ROOT_VERTEX) {
         if (ac->vertices[current_state].is_output) {
-            ac_vertex_t *v = &ac->vertices[current_state];
+            const ac_vertex_t *v = &ac->vertices[current_state];
+            ac_match_t match;
+            match.start = text_pos + 1 - v->depth;
+            match.end = text_pos;
             for (uint8_t i = 0; i < v->num_patterns; ++i) {
-                uint8_t pattern_idx = v->pattern_indices[i];
-                ac->match_callback(ac->patterns[pattern_idx], text_pos);
+                match.pattern = &ac->patterns[v->pattern_indices[i]];
+                match.pattern_id = match.pattern->id;
+                scanner->match_callback(&match, scanner->match_ctx);
+                AC_STAT(scanner->stats.callbacks++);
             }
         }
         current_state = ac->vertices[current_state].link;
+        AC_STAT(scanner->stats.output_hops++);
     }
 }
@@ -0,0 +1,173 @@
+#include "aho_shift_or.h"
+#include <string.h>
+
+AC_RAMFUNC static int char_to_index(char c) {
+    if (c >= 32 && c <= 126) {
+        return c - 32;
+    }
+    return -1;
+}
+
+static void report_matches(const ac_shift_or_table_t *table, const ac_pattern_t *patterns,
+                           size_t text_pos, ac_shift_or_word_t ended,
+                           ac_match_callback_t callback, void* ctx);
+
+void ac_shift_or_init(ac_shift_or_t *so) {
+    if (!so) return;
+
+    ac_shift_or_table_init(&so->table);
+}
+
+// Adiciona um padrão. O id é o próprio índice do padrão.
+bool ac_shift_or_add_pattern(ac_shift_or_t *so, const char* pattern) {
+    if (!so || !pattern) {
+        return false;
+    }
+    return ac_shift_or_add_pattern_ex(so, pattern, strlen(pattern), so->table.pattern_count, 0, NULL);
+}
+
+// Os bytes não são copiados e devem continuar válidos.
+bool ac_shift_or_add_pattern_ex(ac_shift_or_t *so, const char* bytes, size_t len,
+                                ac_pattern_id_t id, uint8_t flags, void* user_data) {
+    if (!so || !ac_shift_or_table_add(&so->table, bytes, len)) {
+        return false;
+    }
+
+    ac_pattern_t *p = &so->patterns[so->table.pattern_count - 1];
+    p->bytes = bytes;
+    p->user_data = user_data;
+    p->id = id;
+    p->length = (uint8_t)len;
+    p->flags = flags;
+    return true;
+}
+
+// Busca em um texto terminado em '\0', com um scanner temporário na pilha.
+void ac_shift_or_search(const ac_shift_or_t *so, const char* text,
+                        ac_match_callback_t callback, void* ctx) {
+    if (!so || !text || so->table.pattern_count == 0) return;
+
+    ac_shift_or_scanner_t scanner;
+    ac_shift_or_scanner_init(&scanner, so, callback, ctx);
+    ac_shift_or_feed(&scanner, text, strlen(text));
+}
+
+void ac_shift_or_scanner_init(ac_shift_or_scanner_t *scanner, const ac_shift_or_t *so,
+                              ac_match_callback_t callback, void* ctx) {
+    if (!scanner) return;
+
+    scanner->so = so;
+    scanner->match_callback = callback;
+    scanner->match_ctx = ctx;
+    ac_shift_or_scanner_reset(scanner);
+}
+
+void ac_shift_or_scanner_reset(ac_shift_or_scanner_t *scanner) {
+    if (!scanner) return;
+
+    scanner->position = 0;
+    scanner->state = AC_SHIFT_OR_IDLE;
+}
+
+void ac_shift_or_feed(ac_shift_or_scanner_t *scanner, const char* data, size_t len) {
+    if (!scanner || !scanner->so || !data) return;
+
+    ac_shift_or_table_scan(&scanner->so->table, scanner->so->patterns, &scanner->state,
+                           scanner->position, data, len,
+                           scanner->match_callback, scanner->match_ctx);
+    scanner->position += len;
+}
+
+void ac_shift_or_table_init(ac_shift_or_table_t *table) {
+    if (!table) return;
+
+    // Bits sem padrão ficam em 1 em todas as máscaras e nunca se ativam
+    for (uint8_t i = 0; i < AC_ALPHABET_SIZE; ++i) {
+        table->masks[i] = AC_SHIFT_OR_IDLE;
+    }
+    table->starts = 0;
+    table->accepts = 0;
+    table->bit_count = 0;
+    table->pattern_count = 0;
+}
+
+bool ac_shift_or_table_add(ac_shift_or_table_t *table, const char* bytes, size_t len) {
+    if (!table || !bytes || len == 0 || len > UINT8_MAX) {
+        return false;
+    }
+
+    size_t valid = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (char_to_index(bytes[i]) != -1) valid++;
+    }
+    if (valid == 0 || table->bit_count + valid > AC_SHIFT_OR_WORD_BITS) {
+        return false;
+    }
+
+    uint8_t first = table->bit_count;
+    for (size_t i = 0; i < len; ++i) {
+        int char_idx = char_to_index(bytes[i]);
+        if (char_idx == -1) continue;
+        table->masks[char_idx] &= ~((ac_shift_or_word_t)1 << table->bit_count);
+        table->bit_count++;
+    }
+    uint8_t last = table->bit_count - 1;
+
+    table->starts |= (ac_shift_or_word_t)1 << first;
+    table->accepts |= (ac_shift_or_word_t)1 << last;
+    table->first_bit[table->pattern_count] = first;
+    table->pattern_at_bit[last] = table->pattern_count;
+    table->pattern_count++;
+    return true;
+}
+
+// O deslocamento leva cada prefixo ativo para a próxima posição do mesmo
+// padrão; o bit que sai do fim de um padrão cai no início do seguinte e é
+// zerado pelo ~starts, que ao mesmo tempo abre uma tentativa nova de cada
+// padrão em todo byte. O OR com a máscara desliga as posições cujo
+// caractere não é o lido.
+AC_RAMFUNC void ac_shift_or_table_scan(const ac_shift_or_table_t *table, const ac_pattern_t *patterns,
+                                       ac_shift_or_word_t *state, size_t position,
+                                       const char* data, size_t len,
+                                       ac_match_callback_t callback, void* ctx) {
+    ac_shift_or_word_t bits = *state;
+    ac_shift_or_word_t not_starts = ~table->starts;
+
+    for (size_t i = 0; i < len; ++i) {
+        int char_idx = char_to_index(data[i]);
+        if (char_idx == -1) {
+            bits = AC_SHIFT_OR_IDLE;
+            continue;
+        }
+
+        bits = ((bits << 1) & not_starts) | table->masks[char_idx];
+        ac_shift_or_word_t ended = ~bits & table->accepts;
+        if (ended) {
+            report_matches(table, patterns, position + i, ended, callback, ctx);
+        }
+    }
+    *state = bits;
+}
+
+// Um callback por bit final em 0, do bit mais baixo (primeiro padrão
+// inserido) para o mais alto. O Cortex-M0 não tem instrução de contar zeros,
+// daí a busca do bit em laço.
+AC_RAMFUNC static void report_matches(const ac_shift_or_table_t *table, const ac_pattern_t *patterns,
+                                      size_t text_pos, ac_shift_or_word_t ended,
+                                      ac_match_callback_t callback, void* ctx) {
+    if (!callback) return;
+
+    ac_match_t match;
+    match.end = text_pos;
+    while (ended) {
+        uint8_t bit = 0;
+        while (!(ended & ((ac_shift_or_word_t)1 << bit))) bit++;
+        ended &= ended - 1;
+
+        uint8_t k = table->pattern_at_bit[bit];
+        match.start = text_pos - (bit - table->first_bit[k]);
+        match.pattern = &patterns[k];
+        match.pattern_id = match.pattern->id;
+        callback(&match, ctx);
+    }
+}
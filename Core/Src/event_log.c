@@ -0,0 +1,61 @@
+#include "event_log.h"
+#include <string.h>
+
+#if (EVENT_LOG_CAPACITY & (EVENT_LOG_CAPACITY - 1)) != 0
+#error "EVENT_LOG_CAPACITY deve ser potência de 2"
+#endif
+
+static event_record_t event_ring[EVENT_LOG_CAPACITY];
+static volatile uint32_t event_head;        // Escrito só pelo produtor
+static volatile uint32_t event_tail;        // Escrito só pelo consumidor
+static volatile uint32_t event_dropped;
+
+void event_log_init(void) {
+    event_head = 0;
+    event_tail = 0;
+    event_dropped = 0;
+}
+
+bool event_log_push(uint32_t timestamp, uint32_t position,
+                    uint16_t packet_id, uint16_t pattern_id) {
+    uint32_t head = event_head;
+    if (head - event_tail >= EVENT_LOG_CAPACITY) {
+        event_dropped++;
+        return false;
+    }
+
+    event_record_t* record = &event_ring[head & (EVENT_LOG_CAPACITY - 1)];
+    record->timestamp = timestamp;
+    record->position = position;
+    record->packet_id = packet_id;
+    record->pattern_id = pattern_id;
+
+    // O registro fica completo antes de o consumidor poder vê-lo
+    __asm volatile ("" ::: "memory");
+    event_head = head + 1;
+    return true;
+}
+
+bool event_log_pop(event_record_t* record) {
+    uint32_t tail = event_tail;
+    if (tail == event_head) return false;
+
+    *record = event_ring[tail & (EVENT_LOG_CAPACITY - 1)];
+    __asm volatile ("" ::: "memory");
+    event_tail = tail + 1;
+    return true;
+}
+
+void event_log_frame(const event_record_t* record, event_log_frame_t* frame) {
+    frame->sync[0] = EVENT_FRAME_SYNC0;
+    frame->sync[1] = EVENT_FRAME_SYNC1;
+    memcpy(frame->record, record, sizeof(*record));
+}
+
+size_t event_log_count(void) {
+    return event_head - event_tail;
+}
+
+uint32_t event_log_dropped(void) {
+    return event_dropped;
+}
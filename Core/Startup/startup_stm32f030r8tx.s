@@ -54,7 +54,8 @@ Reset_Handler:
 /* Call the clock system initialization function.*/
   bl  SystemInit
 
-/* Copy the data segment initializers from flash to SRAM */
+/* Copy the data segment initializers from flash to SRAM.
+   .data also holds the .RamFunc code (_sramfunc.._eramfunc). */
   ldr r0, =_sdata
   ldr r1, =_edata
   ldr r2, =_sidata
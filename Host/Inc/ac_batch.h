@@ -0,0 +1,40 @@
+#ifndef AC_BATCH_H
+#define AC_BATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "aho_corasick.h"
+
+// Camada host (Linux): varre um lote de pacotes em várias threads sobre um
+// único autômato compartilhado. Cada thread começa com uma faixa contígua do
+// lote e, quando a sua acaba, rouba metade da faixa restante de outra.
+
+typedef struct {
+    const char* data;
+    size_t length;
+} ac_batch_packet_t;
+
+typedef enum {
+    AC_VERDICT_CLEAN = 0,
+    AC_VERDICT_MATCH
+} ac_verdict_t;
+
+// Resultado de um pacote, na mesma posição do pacote no lote.
+typedef struct {
+    ac_verdict_t verdict;
+    uint8_t match_flags;            // OU dos flags dos padrões encontrados
+    bool truncated;                 // Faltou memória para guardar todos os matches
+    size_t match_count;
+    ac_match_t* matches;            // Em ordem de posição no pacote
+} ac_batch_result_t;
+
+// Varre count pacotes com num_threads threads (0 usa todos os núcleos
+// online). results deve ter count posições; libere com
+// ac_batch_results_free. Retorna false para argumentos inválidos ou se
+// faltar memória para as filas de trabalho.
+bool ac_batch_scan(const ac_automaton_t* ac, const ac_batch_packet_t* packets,
+                   size_t count, ac_batch_result_t* results, unsigned num_threads);
+void ac_batch_results_free(ac_batch_result_t* results, size_t count);
+
+#endif // AC_BATCH_H
@@ -0,0 +1,38 @@
+#ifndef AC_BUILDER_H
+#define AC_BUILDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "aho_corasick.h"
+
+// Inserção de conjuntos grandes de padrões (host Linux). ac_add_pattern
+// procura cada filho percorrendo a lista de irmãos do vértice; aqui um hash
+// (pai, caractere) -> filho, que dobra de tamanho conforme enche, deixa a
+// construção do Trie proporcional ao total de bytes dos padrões. O Trie é
+// gravado em ac no mesmo formato de ac_add_pattern, então o ac_build
+// seguinte é o mesmo dos dois caminhos.
+
+typedef struct ac_builder ac_builder_t;
+
+// ac já deve ter passado por ac_init e pode ter padrões; eles são indexados.
+// Retorna NULL se faltar memória ou se ac já estiver construído.
+ac_builder_t* ac_builder_create(ac_automaton_t* ac);
+
+// Mesma semântica e mesmos limites de ac_add_pattern_ex. Também retorna
+// false se faltar memória para crescer o hash.
+bool ac_builder_add(ac_builder_t* builder, const char* bytes, size_t len,
+                    ac_pattern_id_t id, uint8_t flags, void* user_data);
+
+// Libera só o hash; o Trie continua em ac, pronto para ac_build.
+void ac_builder_free(ac_builder_t* builder);
+
+// ac_build com os links de falha calculados nível a nível: os vértices de
+// um nível da BFS só dependem de níveis mais rasos, então cada nível grande
+// é dividido entre threads e o seguinte só começa quando ele termina. O
+// resultado é idêntico ao de ac_build. num_threads igual a 0 usa todos os
+// núcleos online; se uma thread não puder ser criada, as outras fazem a
+// parte dela. Retorna false se ac for NULL ou já estiver construído.
+bool ac_build_parallel(ac_automaton_t* ac, unsigned num_threads);
+
+#endif // AC_BUILDER_H
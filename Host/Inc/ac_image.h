@@ -0,0 +1,18 @@
+#ifndef AC_IMAGE_H
+#define AC_IMAGE_H
+
+#include <stdbool.h>
+#include "aho_corasick.h"
+
+// Imagem serializada de um autômato já construído: tabelas congeladas mais
+// os bytes e metadados dos padrões (user_data não é salvo). A imagem só é
+// lida por um build com o mesmo aho_config.h que a gravou.
+
+bool ac_image_save(const ac_automaton_t* ac, const char* path);
+
+// Retorna um autômato pronto para busca, alocado num único bloco junto com
+// os bytes dos padrões; libere com free. Retorna NULL se o arquivo não
+// existir, estiver truncado ou tiver sido gravado com outra configuração.
+ac_automaton_t* ac_image_load(const char* path);
+
+#endif // AC_IMAGE_H
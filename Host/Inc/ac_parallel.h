@@ -0,0 +1,30 @@
+#ifndef AC_PARALLEL_H
+#define AC_PARALLEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aho_corasick.h"
+
+// Varredura paralela de um único buffer grande (host Linux). O buffer é
+// dividido em blocos; cada bloco começa a ser varrido (maior padrão - 1)
+// bytes antes do seu início, e só reporta os matches que terminam dentro
+// dele. O resultado é exatamente o de um ac_scanner_feed sequencial sobre o
+// buffer inteiro, entregue na mesma ordem e na thread chamadora. Quando o
+// autômato tem poucos padrões, os blocos passam pelo prefiltro ac_teddy.
+
+// num_threads igual a 0 usa todos os núcleos online. Retorna false para
+// argumentos inválidos ou falta de memória (nesse caso nada é reportado).
+bool ac_parallel_scan(const ac_automaton_t* ac, const char* data, size_t len,
+                      unsigned num_threads, ac_match_callback_t callback, void* ctx);
+
+// Mapeia o arquivo com mmap e o varre com ac_parallel_scan. Entradas que
+// não são arquivos regulares (pipes, FIFOs, /dev/stdin) são lidas em blocos
+// e varridas sequencialmente. Retorna false (com errno) se o arquivo não
+// puder ser aberto, lido ou mapeado.
+bool ac_parallel_scan_file(const ac_automaton_t* ac, const char* path,
+                           unsigned num_threads, ac_match_callback_t callback, void* ctx);
+
+// Quantos bytes dois blocos vizinhos precisam compartilhar: maior padrão - 1.
+size_t ac_parallel_overlap(const ac_automaton_t* ac);
+
+#endif // AC_PARALLEL_H
@@ -0,0 +1,42 @@
+#ifndef AC_TEDDY_H
+#define AC_TEDDY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aho_corasick.h"
+
+// Prefiltro SIMD no estilo Teddy para o host. Os padrões são divididos em
+// até 8 grupos (um bit cada) e, para os primeiros bytes dos padrões, duas
+// tabelas de 16 entradas por byte dizem quais grupos aceitam cada nibble
+// alto e baixo. Com pshufb (SSSE3: 16 posições, AVX2: 32 por iteração) as
+// tabelas são consultadas para todas as posições de uma vez; só as posições
+// em que algum grupo aceita todos os bytes são candidatas a início de
+// padrão. O autômato verifica apenas a partir delas, o que na maior parte
+// do tráfego limpo significa não executar get_next_state.
+
+#define AC_TEDDY_MAX_PATTERNS 256   // Acima disso quase toda posição é candidata
+
+typedef struct ac_teddy ac_teddy_t;
+
+// Monta as tabelas a partir dos padrões de um autômato construído. Retorna
+// NULL se não houver padrões, se houver mais que AC_TEDDY_MAX_PATTERNS ou
+// algum padrão sem caracteres válidos, ou se faltar memória; nesses casos o
+// chamador usa ac_scanner_feed direto.
+ac_teddy_t* ac_teddy_create(const ac_automaton_t* ac);
+void ac_teddy_free(ac_teddy_t* teddy);
+
+// Conjunto de instruções escolhido em tempo de execução: "avx2", "ssse3"
+// ou "scalar".
+const char* ac_teddy_isa(const ac_teddy_t* teddy);
+
+// Primeira posição >= from em que algum padrão pode começar. Posições tão
+// perto do fim que os bytes de teste não cabem em data também contam como
+// candidatas; retorna len se não houver nenhuma.
+size_t ac_teddy_find(const ac_teddy_t* teddy, const char* data, size_t from, size_t len);
+
+// Mesmo efeito de ac_scanner_feed (mesmos matches, posição e estado), mas
+// pulando, sempre que o scanner está na raiz, até o próximo candidato.
+void ac_teddy_feed(const ac_teddy_t* teddy, ac_scanner_t* scanner,
+                   const char* data, size_t len);
+
+#endif // AC_TEDDY_H
@@ -0,0 +1,212 @@
+#include "ac_batch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_LINE_SIZE 64
+
+// Faixa [head, tail) de pacotes de uma thread, num único inteiro de 64 bits
+// para que a dona (que tira do início) e os ladrões (que tiram do fim)
+// disputem com um CAS só.
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t range;
+} work_deque_t;
+
+typedef struct batch_job batch_job_t;
+
+typedef struct {
+    batch_job_t* job;
+    unsigned index;
+    pthread_t thread;
+    bool failed;
+} batch_worker_t;
+
+struct batch_job {
+    const ac_automaton_t* ac;
+    const ac_batch_packet_t* packets;
+    ac_batch_result_t* results;
+    work_deque_t* deques;
+    batch_worker_t* workers;
+    unsigned num_workers;
+};
+
+static inline uint64_t pack_range(uint32_t head, uint32_t tail) {
+    return ((uint64_t)head << 32) | tail;
+}
+
+static inline uint32_t range_head(uint64_t range) { return (uint32_t)(range >> 32); }
+static inline uint32_t range_tail(uint64_t range) { return (uint32_t)range; }
+
+// Tira o próximo pacote do início da própria faixa.
+static bool pop_own(work_deque_t* deque, uint32_t* index) {
+    uint64_t range = atomic_load_explicit(&deque->range, memory_order_relaxed);
+    while (range_head(range) < range_tail(range)) {
+        uint64_t next = pack_range(range_head(range) + 1, range_tail(range));
+        if (atomic_compare_exchange_weak(&deque->range, &range, next)) {
+            *index = range_head(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Rouba a metade final (arredondada para cima) da faixa de uma vítima.
+static bool steal_half(work_deque_t* victim, uint32_t* head, uint32_t* tail) {
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_relaxed);
+    while (range_head(range) < range_tail(range)) {
+        uint32_t remaining = range_tail(range) - range_head(range);
+        uint32_t split = range_tail(range) - (remaining + 1) / 2;
+        uint64_t next = pack_range(range_head(range), split);
+        if (atomic_compare_exchange_weak(&victim->range, &range, next)) {
+            *head = split;
+            *tail = range_tail(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Garante espaço para mais um match. A capacidade é implícita: 4 e depois
+// potências de dois, crescendo quando a contagem atinge uma delas.
+static bool reserve_match(ac_batch_result_t* result) {
+    size_t count = result->match_count;
+    size_t capacity = 0;
+
+    if (count == 0) {
+        capacity = 4;
+    } else if (count >= 4 && (count & (count - 1)) == 0) {
+        capacity = 2 * count;
+    } else {
+        return true;
+    }
+
+    ac_match_t* grown = realloc(result->matches, capacity * sizeof(ac_match_t));
+    if (!grown) return false;
+    result->matches = grown;
+    return true;
+}
+
+static void collect_match(const ac_match_t* match, void* ctx) {
+    ac_batch_result_t* result = (ac_batch_result_t*)ctx;
+
+    // O veredito vale mesmo quando falta memória para a lista
+    result->verdict = AC_VERDICT_MATCH;
+    result->match_flags |= match->pattern->flags;
+    if (reserve_match(result)) {
+        result->matches[result->match_count++] = *match;
+    } else {
+        result->truncated = true;
+    }
+}
+
+static void scan_packet(const batch_job_t* job, ac_scanner_t* scanner, uint32_t index) {
+    ac_batch_result_t* result = &job->results[index];
+
+    scanner->match_ctx = result;
+    ac_scanner_reset(scanner);
+    ac_scanner_feed(scanner, job->packets[index].data, job->packets[index].length);
+}
+
+static void* worker_main(void* arg) {
+    batch_worker_t* worker = (batch_worker_t*)arg;
+    batch_job_t* job = worker->job;
+    work_deque_t* own = &job->deques[worker->index];
+    ac_scanner_t scanner;
+    uint32_t index;
+
+    ac_scanner_init(&scanner, job->ac, collect_match, NULL);
+
+    for (;;) {
+        while (pop_own(own, &index)) {
+            scan_packet(job, &scanner, index);
+        }
+
+        // Faixa vazia: procura trabalho nas outras threads, a partir da vizinha
+        bool stolen = false;
+        for (unsigned i = 1; i < job->num_workers && !stolen; ++i) {
+            unsigned victim = (worker->index + i) % job->num_workers;
+            uint32_t head, tail;
+            if (steal_half(&job->deques[victim], &head, &tail)) {
+                // O primeiro pacote roubado é varrido já; o resto vira a faixa própria
+                atomic_store(&own->range, pack_range(head + 1, tail));
+                scan_packet(job, &scanner, head);
+                stolen = true;
+            }
+        }
+        if (!stolen) {
+            // Tudo vazio: o que ainda estiver sendo redistribuído já tem dono
+            break;
+        }
+    }
+    return NULL;
+}
+
+static unsigned online_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (unsigned)n : 1;
+}
+
+bool ac_batch_scan(const ac_automaton_t* ac, const ac_batch_packet_t* packets,
+                   size_t count, ac_batch_result_t* results, unsigned num_threads) {
+    if (!ac || (!packets && count > 0) || (!results && count > 0) || count > UINT32_MAX) {
+        return false;
+    }
+
+    memset(results, 0, count * sizeof(ac_batch_result_t));
+    if (count == 0) return true;
+
+    if (num_threads == 0) num_threads = online_cpus();
+    if (num_threads > count) num_threads = (unsigned)count;
+
+    batch_job_t job;
+    job.ac = ac;
+    job.packets = packets;
+    job.results = results;
+    job.num_workers = num_threads;
+    job.deques = aligned_alloc(CACHE_LINE_SIZE, num_threads * sizeof(work_deque_t));
+    job.workers = calloc(num_threads, sizeof(batch_worker_t));
+    if (!job.deques || !job.workers) {
+        free(job.deques);
+        free(job.workers);
+        return false;
+    }
+
+    // Divisão inicial em faixas contíguas de tamanho quase igual
+    for (unsigned i = 0; i < num_threads; ++i) {
+        uint32_t head = (uint32_t)(count * i / num_threads);
+        uint32_t tail = (uint32_t)(count * (i + 1) / num_threads);
+        atomic_init(&job.deques[i].range, pack_range(head, tail));
+        job.workers[i].job = &job;
+        job.workers[i].index = i;
+    }
+
+    // A thread chamadora trabalha como worker 0. Se uma thread não puder ser
+    // criada, a faixa dela é roubada pelas outras.
+    for (unsigned i = 1; i < num_threads; ++i) {
+        if (pthread_create(&job.workers[i].thread, NULL, worker_main, &job.workers[i]) != 0) {
+            job.workers[i].failed = true;
+        }
+    }
+    worker_main(&job.workers[0]);
+    for (unsigned i = 1; i < num_threads; ++i) {
+        if (!job.workers[i].failed) {
+            pthread_join(job.workers[i].thread, NULL);
+        }
+    }
+
+    free(job.deques);
+    free(job.workers);
+    return true;
+}
+
+void ac_batch_results_free(ac_batch_result_t* results, size_t count) {
+    if (!results) return;
+
+    for (size_t i = 0; i < count; ++i) {
+        free(results[i].matches);
+        results[i].matches = NULL;
+        results[i].match_count = 0;
+    }
+}
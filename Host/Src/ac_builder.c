@@ -0,0 +1,233 @@
+#include "ac_builder.h"
+#include "aho_internal.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Capacidade inicial do hash (potência de 2); dobra acima de 50% de ocupação.
+#define INITIAL_BITS 12
+
+// Posições da BFS que uma thread pega de cada vez, e tamanho mínimo de um
+// nível para valer a pena criar as threads.
+#define LINK_CHUNK 4096
+#define MIN_PARALLEL_LEVEL (4 * LINK_CHUNK)
+
+// Chave e filho juntos, para uma consulta tocar uma única linha de cache.
+typedef struct {
+    uint64_t key;                   // (pai << 8) | caractere
+    ac_state_t child;               // INVALID_VERTEX marca entrada vazia
+} edge_entry_t;
+
+typedef struct {
+    ac_automaton_t* ac;
+    ac_state_t end;                 // Fim da faixa de posições da BFS do nível
+    _Atomic size_t next;            // Próxima posição ainda não reservada
+} level_job_t;
+
+struct ac_builder {
+    ac_automaton_t* ac;
+    edge_entry_t* table;
+    size_t capacity;
+    size_t count;
+    unsigned bits;
+};
+
+static size_t slot_of(uint64_t key, unsigned bits) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+static uint64_t edge_key(ac_state_t parent, uint8_t char_idx) {
+    return ((uint64_t)parent << 8) | char_idx;
+}
+
+static bool alloc_table(ac_builder_t* b, unsigned bits) {
+    size_t capacity = (size_t)1 << bits;
+    edge_entry_t* table = malloc(capacity * sizeof(edge_entry_t));
+    if (!table) return false;
+
+    for (size_t i = 0; i < capacity; ++i) {
+        table[i].child = INVALID_VERTEX;
+    }
+    b->table = table;
+    b->capacity = capacity;
+    b->bits = bits;
+    return true;
+}
+
+static void insert_edge(ac_builder_t* b, uint64_t key, ac_state_t child) {
+    size_t mask = b->capacity - 1;
+    size_t i = slot_of(key, b->bits);
+    while (b->table[i].child != INVALID_VERTEX) {
+        i = (i + 1) & mask;
+    }
+    b->table[i].key = key;
+    b->table[i].child = child;
+    b->count++;
+}
+
+static ac_state_t lookup_edge(const ac_builder_t* b, uint64_t key) {
+    size_t mask = b->capacity - 1;
+    size_t i = slot_of(key, b->bits);
+    while (b->table[i].child != INVALID_VERTEX) {
+        if (b->table[i].key == key) return b->table[i].child;
+        i = (i + 1) & mask;
+    }
+    return INVALID_VERTEX;
+}
+
+static bool grow(ac_builder_t* b) {
+    edge_entry_t* old_table = b->table;
+    size_t old_capacity = b->capacity;
+
+    if (!alloc_table(b, b->bits + 1)) return false;
+    b->count = 0;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_table[i].child != INVALID_VERTEX) {
+            insert_edge(b, old_table[i].key, old_table[i].child);
+        }
+    }
+    free(old_table);
+    return true;
+}
+
+ac_builder_t* ac_builder_create(ac_automaton_t* ac) {
+    if (!ac || ac->is_built) return NULL;
+
+    ac_builder_t* b = malloc(sizeof(ac_builder_t));
+    if (!b) return NULL;
+    b->ac = ac;
+    b->count = 0;
+
+    unsigned bits = INITIAL_BITS;
+    while (((size_t)1 << bits) < 2 * (size_t)ac->vertex_count) bits++;
+    if (!alloc_table(b, bits)) {
+        free(b);
+        return NULL;
+    }
+
+    // Indexa as arestas de padrões inseridos antes com ac_add_pattern
+    for (ac_state_t v = 0; v < ac->vertex_count; ++v) {
+        ac_state_t child = ac->vertices[v].trie.first_child;
+        while (child != INVALID_VERTEX) {
+            insert_edge(b, edge_key(v, ac->vertices[child].trie.character), child);
+            child = ac->vertices[child].trie.next_sibling;
+        }
+    }
+    return b;
+}
+
+bool ac_builder_add(ac_builder_t* b, const char* bytes, size_t len,
+                    ac_pattern_id_t id, uint8_t flags, void* user_data) {
+    if (!b) return false;
+
+    ac_automaton_t* ac = b->ac;
+    if (ac->is_built || !bytes || len == 0 || len > UINT8_MAX
+        || ac->pattern_count >= AC_MAX_PATTERNS
+        || ac->vertex_count + len > AC_MAX_VERTICES) {
+        return false;
+    }
+    if (2 * (b->count + len) > b->capacity && !grow(b)) {
+        return false;
+    }
+
+    // Se o caminho já existe inteiro, o fim precisa ter espaço para mais
+    // uma saída; conferido antes de inserir para não deixar vértices órfãos
+    ac_state_t existing = 0;
+    for (size_t i = 0; i < len && existing != INVALID_VERTEX; ++i) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (c < 32 || c > 126) continue; // Mesmo alfabeto de ac_add_pattern
+        existing = lookup_edge(b, edge_key(existing, (uint8_t)(c - 32)));
+    }
+    if (existing != INVALID_VERTEX && !ac_trie_can_output(ac, existing)) {
+        return false;
+    }
+
+    ac_state_t current = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (c < 32 || c > 126) continue;
+
+        uint8_t char_idx = (uint8_t)(c - 32);
+        uint64_t key = edge_key(current, char_idx);
+        ac_state_t next = lookup_edge(b, key);
+
+        if (next == INVALID_VERTEX) {
+            next = ac_trie_add_child(ac, current, char_idx);
+            insert_edge(b, key, next);
+        }
+        current = next;
+    }
+
+    return ac_trie_add_output(ac, current, bytes, len, id, flags, user_data);
+}
+
+void ac_builder_free(ac_builder_t* b) {
+    if (!b) return;
+
+    free(b->table);
+    free(b);
+}
+
+static void* link_worker(void* arg) {
+    level_job_t* job = (level_job_t*)arg;
+
+    for (;;) {
+        size_t first = atomic_fetch_add(&job->next, LINK_CHUNK);
+        if (first >= job->end) break;
+        size_t last = first + LINK_CHUNK;
+        if (last > job->end) last = job->end;
+        ac_build_links(job->ac, (ac_state_t)first, (ac_state_t)last);
+    }
+    return NULL;
+}
+
+bool ac_build_parallel(ac_automaton_t* ac, unsigned num_threads) {
+    if (!ac || ac->is_built) return false;
+
+    if (num_threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (n > 0) ? (unsigned)n : 1;
+    }
+    pthread_t* threads = calloc(num_threads, sizeof(pthread_t));
+    bool* started = calloc(num_threads, sizeof(bool));
+    if (!threads || !started) num_threads = 1;
+
+    ac_build_goto(ac);
+
+    // Cada nível é uma faixa contígua da BFS com a mesma profundidade
+    ac_state_t begin = 0;
+    while (begin < ac->vertex_count) {
+        uint8_t depth = ac->vertices[ac_bfs_vertex(ac, begin)].depth;
+        ac_state_t end = begin + 1;
+        while (end < ac->vertex_count && ac->vertices[ac_bfs_vertex(ac, end)].depth == depth) {
+            end++;
+        }
+
+        if (num_threads == 1 || end - begin < MIN_PARALLEL_LEVEL) {
+            ac_build_links(ac, begin, end);
+        } else {
+            level_job_t job;
+            job.ac = ac;
+            job.end = end;
+            atomic_init(&job.next, begin);
+
+            // A thread chamadora também processa blocos do nível
+            for (unsigned i = 1; i < num_threads; ++i) {
+                started[i] = (pthread_create(&threads[i], NULL, link_worker, &job) == 0);
+            }
+            link_worker(&job);
+            for (unsigned i = 1; i < num_threads; ++i) {
+                if (started[i]) pthread_join(threads[i], NULL);
+            }
+        }
+        begin = end;
+    }
+
+    free(threads);
+    free(started);
+    ac_build_prefilter(ac);
+    ac_select_engine(ac);
+    ac->is_built = true;
+    return true;
+}
@@ -0,0 +1,158 @@
+#include "ac_image.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AC_IMAGE_MAGIC "ACIM"
+#define AC_IMAGE_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    // Layout das tabelas; uma imagem de outra configuração é recusada
+    uint32_t vertex_size;
+    uint32_t transition_size;
+    uint32_t max_vertices;
+    uint32_t max_patterns;
+    uint32_t vertex_count;
+    uint32_t transition_count;
+    uint32_t pattern_count;
+    uint32_t pattern_bytes;         // Soma dos tamanhos de todos os padrões
+} image_header_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t flags;
+    uint32_t length;
+} image_pattern_t;
+
+static void fill_layout(image_header_t* header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, AC_IMAGE_MAGIC, sizeof(header->magic));
+    header->version = AC_IMAGE_VERSION;
+    header->vertex_size = sizeof(ac_vertex_t);
+    header->transition_size = sizeof(ac_transition_t);
+    header->max_vertices = AC_MAX_VERTICES;
+    header->max_patterns = AC_MAX_PATTERNS;
+}
+
+// Confere os índices internos de uma imagem lida: o scanner os usa sem
+// verificar, e uma imagem truncada ou corrompida faria leituras fora das
+// tabelas. Os intervalos dos padrões no bloco de bytes já são conferidos
+// na leitura.
+static bool validate_image(const ac_automaton_t* ac) {
+    for (uint32_t i = 0; i < ac->transition_count; ++i) {
+        const ac_transition_t* t = &ac->transitions[i];
+        if (t->next_vertex >= ac->vertex_count || t->character >= AC_ALPHABET_SIZE) return false;
+    }
+
+    for (uint32_t i = 0; i < ac->vertex_count; ++i) {
+        const ac_vertex_t* v = &ac->vertices[i];
+        if ((uint32_t)v->first_transition + v->num_transitions > ac->transition_count
+            || v->link >= ac->vertex_count
+            || v->num_patterns > AC_MAX_PATTERNS_PER_VERTEX) {
+            return false;
+        }
+        for (uint8_t k = 0; k < v->num_patterns; ++k) {
+            if (v->pattern_indices[k] >= ac->pattern_count) return false;
+        }
+    }
+    return true;
+}
+
+bool ac_image_save(const ac_automaton_t* ac, const char* path) {
+    if (!ac || !ac->is_built || !path) return false;
+
+    image_header_t header;
+    fill_layout(&header);
+    header.vertex_count = ac->vertex_count;
+    header.transition_count = ac->transition_count;
+    header.pattern_count = ac->pattern_count;
+    for (uint32_t i = 0; i < header.pattern_count; ++i) {
+        header.pattern_bytes += ac->patterns[i].length;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+        && fwrite(ac->vertices, sizeof(ac_vertex_t), header.vertex_count, f) == header.vertex_count
+        && fwrite(ac->transitions, sizeof(ac_transition_t), header.transition_count, f) == header.transition_count;
+
+    for (uint32_t i = 0; ok && i < header.pattern_count; ++i) {
+        image_pattern_t p = { ac->patterns[i].id, ac->patterns[i].flags, ac->patterns[i].length };
+        ok = fwrite(&p, sizeof(p), 1, f) == 1;
+    }
+    for (uint32_t i = 0; ok && i < header.pattern_count; ++i) {
+        ok = fwrite(ac->patterns[i].bytes, 1, ac->patterns[i].length, f) == ac->patterns[i].length;
+    }
+
+    if (fclose(f) != 0) ok = false;
+    if (!ok) remove(path);
+    return ok;
+}
+
+ac_automaton_t* ac_image_load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    image_header_t header, expected;
+    fill_layout(&expected);
+    if (fread(&header, sizeof(header), 1, f) != 1
+        || memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+        || header.version != expected.version
+        || header.vertex_size != expected.vertex_size
+        || header.transition_size != expected.transition_size
+        || header.max_vertices != expected.max_vertices
+        || header.max_patterns != expected.max_patterns
+        || header.vertex_count == 0 || header.vertex_count > AC_MAX_VERTICES
+        || header.transition_count != header.vertex_count - 1
+        || header.pattern_count > AC_MAX_PATTERNS) {
+        fclose(f);
+        return NULL;
+    }
+
+    ac_automaton_t* ac = malloc(sizeof(ac_automaton_t) + header.pattern_bytes);
+    if (!ac) {
+        fclose(f);
+        return NULL;
+    }
+    ac_init(ac);
+    char* bytes = (char*)(ac + 1);
+
+    bool ok = fread(ac->vertices, sizeof(ac_vertex_t), header.vertex_count, f) == header.vertex_count
+        && fread(ac->transitions, sizeof(ac_transition_t), header.transition_count, f) == header.transition_count;
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; ok && i < header.pattern_count; ++i) {
+        image_pattern_t p;
+        ok = fread(&p, sizeof(p), 1, f) == 1 && p.length <= UINT8_MAX
+            && p.length <= header.pattern_bytes - offset;
+        if (ok) {
+            ac->patterns[i].bytes = bytes + offset;
+            ac->patterns[i].user_data = NULL;
+            ac->patterns[i].id = p.id;
+            ac->patterns[i].flags = p.flags;
+            ac->patterns[i].length = p.length;
+            offset += p.length;
+        }
+    }
+    ok = ok && fread(bytes, 1, header.pattern_bytes, f) == header.pattern_bytes;
+    fclose(f);
+
+    ac->vertex_count = header.vertex_count;
+    ac->transition_count = header.transition_count;
+    ac->pattern_count = header.pattern_count;
+    if (!ok || !validate_image(ac)) {
+        free(ac);
+        return NULL;
+    }
+
+    // Prefiltro e motor não fazem parte da imagem: recalculados aqui (o
+    // prefiltro com a tabela de frequências embutida)
+    ac_build_prefilter(ac);
+    ac_select_engine(ac);
+    ac->is_built = true;
+    return ac;
+}
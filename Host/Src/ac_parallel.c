@@ -0,0 +1,222 @@
+#include "ac_parallel.h"
+#include "ac_teddy.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Blocos por thread, para equilibrar a carga quando a densidade de matches
+// varia ao longo do arquivo, e tamanho mínimo de um bloco.
+#define CHUNKS_PER_THREAD 4
+#define MIN_CHUNK_SIZE (1u << 20)
+
+// Bloco de leitura para entradas que não podem ser mapeadas.
+#define STREAM_BLOCK_SIZE (1u << 20)
+
+typedef struct {
+    size_t begin;                   // Primeiro byte que o bloco reporta
+    size_t end;                     // Um além do último byte do bloco
+    ac_match_t* matches;
+    size_t match_count;
+    size_t match_capacity;
+    bool failed;                    // Faltou memória para a lista de matches
+} scan_chunk_t;
+
+typedef struct {
+    const ac_automaton_t* ac;
+    const ac_teddy_t* teddy;        // NULL quando o prefiltro não se aplica
+    const char* data;
+    size_t overlap;
+    scan_chunk_t* chunks;
+    size_t num_chunks;
+    _Atomic size_t next_chunk;
+} parallel_job_t;
+
+static void collect_match(const ac_match_t* match, void* ctx) {
+    scan_chunk_t* chunk = (scan_chunk_t*)ctx;
+
+    // Matches que terminam na sobreposição pertencem ao bloco anterior
+    if (match->end < chunk->begin || chunk->failed) return;
+
+    if (chunk->match_count == chunk->match_capacity) {
+        size_t capacity = chunk->match_capacity ? 2 * chunk->match_capacity : 64;
+        ac_match_t* grown = realloc(chunk->matches, capacity * sizeof(ac_match_t));
+        if (!grown) {
+            chunk->failed = true;
+            return;
+        }
+        chunk->matches = grown;
+        chunk->match_capacity = capacity;
+    }
+    chunk->matches[chunk->match_count++] = *match;
+}
+
+static void scan_chunk(const parallel_job_t* job, scan_chunk_t* chunk) {
+    size_t start = (chunk->begin > job->overlap) ? chunk->begin - job->overlap : 0;
+    ac_scanner_t scanner;
+
+    // O scanner parte da raiz em start e conta posições desde o início do buffer
+    ac_scanner_init(&scanner, job->ac, collect_match, chunk);
+    scanner.position = start;
+    if (job->teddy) {
+        ac_teddy_feed(job->teddy, &scanner, job->data + start, chunk->end - start);
+    } else {
+        ac_scanner_feed(&scanner, job->data + start, chunk->end - start);
+    }
+}
+
+static void* worker_main(void* arg) {
+    parallel_job_t* job = (parallel_job_t*)arg;
+
+    for (;;) {
+        size_t index = atomic_fetch_add(&job->next_chunk, 1);
+        if (index >= job->num_chunks) break;
+        scan_chunk(job, &job->chunks[index]);
+    }
+    return NULL;
+}
+
+size_t ac_parallel_overlap(const ac_automaton_t* ac) {
+    size_t longest = 0;
+
+    for (size_t i = 0; i < ac->pattern_count; ++i) {
+        if (ac->patterns[i].length > longest) {
+            longest = ac->patterns[i].length;
+        }
+    }
+    return longest ? longest - 1 : 0;
+}
+
+bool ac_parallel_scan(const ac_automaton_t* ac, const char* data, size_t len,
+                      unsigned num_threads, ac_match_callback_t callback, void* ctx) {
+    if (!ac || (!data && len > 0)) return false;
+    if (len == 0) return true;
+
+    if (num_threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (n > 0) ? (unsigned)n : 1;
+    }
+
+    size_t chunk_size = len / ((size_t)num_threads * CHUNKS_PER_THREAD);
+    if (chunk_size < MIN_CHUNK_SIZE) chunk_size = MIN_CHUNK_SIZE;
+
+    parallel_job_t job;
+    job.ac = ac;
+    job.data = data;
+    job.overlap = ac_parallel_overlap(ac);
+    job.num_chunks = (len + chunk_size - 1) / chunk_size;
+    atomic_init(&job.next_chunk, 0);
+    job.chunks = calloc(job.num_chunks, sizeof(scan_chunk_t));
+    if (!job.chunks) return false;
+
+    for (size_t i = 0; i < job.num_chunks; ++i) {
+        job.chunks[i].begin = i * chunk_size;
+        job.chunks[i].end = (i + 1 == job.num_chunks) ? len : (i + 1) * chunk_size;
+    }
+
+    if (num_threads > job.num_chunks) num_threads = (unsigned)job.num_chunks;
+    pthread_t* threads = calloc(num_threads, sizeof(pthread_t));
+    bool* started = calloc(num_threads, sizeof(bool));
+    if (!threads || !started) {
+        free(threads);
+        free(started);
+        free(job.chunks);
+        return false;
+    }
+
+    // Com poucos padrões, o prefiltro SIMD pula os trechos sem candidatos
+    ac_teddy_t* teddy = ac_teddy_create(ac);
+    job.teddy = teddy;
+
+    // A thread chamadora também varre blocos
+    for (unsigned i = 1; i < num_threads; ++i) {
+        started[i] = (pthread_create(&threads[i], NULL, worker_main, &job) == 0);
+    }
+    worker_main(&job);
+    for (unsigned i = 1; i < num_threads; ++i) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    ac_teddy_free(teddy);
+
+    bool ok = true;
+    for (size_t i = 0; i < job.num_chunks; ++i) {
+        if (job.chunks[i].failed) ok = false;
+    }
+
+    // Entrega em ordem de bloco, que é a ordem da varredura sequencial
+    for (size_t i = 0; i < job.num_chunks; ++i) {
+        scan_chunk_t* chunk = &job.chunks[i];
+        for (size_t m = 0; ok && callback && m < chunk->match_count; ++m) {
+            callback(&chunk->matches[m], ctx);
+        }
+        free(chunk->matches);
+    }
+
+    free(threads);
+    free(started);
+    free(job.chunks);
+    return ok;
+}
+
+// Pipes, FIFOs e dispositivos não têm tamanho conhecido (st_size é 0) e
+// nem sempre podem ser mapeados: são lidos em blocos por um único scanner.
+static bool scan_stream(const ac_automaton_t* ac, int fd,
+                        ac_match_callback_t callback, void* ctx) {
+    char* block = malloc(STREAM_BLOCK_SIZE);
+    if (!block) return false;
+
+    ac_scanner_t scanner;
+    ac_scanner_init(&scanner, ac, callback, ctx);
+
+    ssize_t n;
+    while ((n = read(fd, block, STREAM_BLOCK_SIZE)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        ac_scanner_feed(&scanner, block, (size_t)n);
+    }
+    free(block);
+    return n == 0;
+}
+
+bool ac_parallel_scan_file(const ac_automaton_t* ac, const char* path,
+                           unsigned num_threads, ac_match_callback_t callback, void* ctx) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        bool ok = scan_stream(ac, fd, callback, ctx);
+        int saved_errno = errno;
+        close(fd);
+        errno = saved_errno;
+        return ok;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    size_t len = (size_t)st.st_size;
+    char* data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    int saved_errno = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+        errno = saved_errno;
+        return false;
+    }
+    madvise(data, len, MADV_WILLNEED);
+
+    bool ok = ac_parallel_scan(ac, data, len, num_threads, callback, ctx);
+    munmap(data, len);
+    return ok;
+}
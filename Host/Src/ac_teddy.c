@@ -0,0 +1,205 @@
+#include "ac_teddy.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEDDY_X86 1
+#else
+#define TEDDY_X86 0
+#endif
+
+// Bytes de cada padrão usados no teste (limitado pelo padrão mais curto)
+#define TEDDY_MAX_PREFIX 3
+#define TEDDY_BUCKETS 8
+
+// Bytes entregues ao autômato depois de um candidato antes de testar de
+// novo se o scanner voltou para a raiz.
+#define VERIFY_BLOCK 16
+
+typedef size_t (*find_fn_t)(const ac_teddy_t* t, const uint8_t* data, size_t from, size_t end);
+
+struct ac_teddy {
+    // lo[k][n] / hi[k][n]: grupos com algum padrão cujo byte k tem n como
+    // nibble baixo / alto
+    _Alignas(16) uint8_t lo[TEDDY_MAX_PREFIX][16];
+    _Alignas(16) uint8_t hi[TEDDY_MAX_PREFIX][16];
+    size_t prefix_len;
+    find_fn_t find;
+    const char* isa;
+};
+
+typedef struct {
+    uint8_t bytes[TEDDY_MAX_PREFIX];
+} prefix_t;
+
+static int compare_prefix(const void* a, const void* b) {
+    return memcmp(a, b, sizeof(prefix_t));
+}
+
+// Só os caracteres que o autômato aceita fazem parte do caminho no Trie
+// (ac_add_pattern ignora os demais); os prefixos vêm desse caminho.
+static size_t filtered_prefix(const ac_pattern_t* p, uint8_t* out, size_t max) {
+    size_t n = 0;
+    for (size_t i = 0; i < p->length && n < max; ++i) {
+        uint8_t c = (uint8_t)p->bytes[i];
+        if (c >= 32 && c <= 126) out[n++] = c;
+    }
+    return n;
+}
+
+static size_t find_scalar(const ac_teddy_t* t, const uint8_t* data, size_t from, size_t end) {
+    for (size_t j = from; j < end; ++j) {
+        uint8_t res = 0xff;
+        for (size_t k = 0; k < t->prefix_len; ++k) {
+            uint8_t c = data[j + k];
+            res &= t->lo[k][c & 0x0f] & t->hi[k][c >> 4];
+        }
+        if (res) return j;
+    }
+    return end;
+}
+
+#if TEDDY_X86
+__attribute__((target("ssse3")))
+static size_t find_ssse3(const ac_teddy_t* t, const uint8_t* data, size_t from, size_t end) {
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+    size_t j = from;
+
+    for (; j + 16 <= end; j += 16) {
+        __m128i res = _mm_set1_epi8((char)0xff);
+        for (size_t k = 0; k < t->prefix_len; ++k) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(data + j + k));
+            __m128i lo = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)t->lo[k]),
+                                          _mm_and_si128(v, nibble));
+            __m128i hi = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)t->hi[k]),
+                                          _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            res = _mm_and_si128(res, _mm_and_si128(lo, hi));
+        }
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(res, zero)) & 0xffffu;
+        if (mask) return j + (size_t)__builtin_ctz(mask);
+    }
+    return find_scalar(t, data, j, end);
+}
+
+__attribute__((target("avx2")))
+static size_t find_avx2(const ac_teddy_t* t, const uint8_t* data, size_t from, size_t end) {
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo_table[TEDDY_MAX_PREFIX], hi_table[TEDDY_MAX_PREFIX];
+    size_t j = from;
+
+    // pshufb de 256 bits consulta cada metade separadamente: tabela repetida
+    for (size_t k = 0; k < t->prefix_len; ++k) {
+        lo_table[k] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)t->lo[k]));
+        hi_table[k] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)t->hi[k]));
+    }
+
+    for (; j + 32 <= end; j += 32) {
+        __m256i res = _mm256_set1_epi8((char)0xff);
+        for (size_t k = 0; k < t->prefix_len; ++k) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(data + j + k));
+            __m256i lo = _mm256_shuffle_epi8(lo_table[k], _mm256_and_si256(v, nibble));
+            __m256i hi = _mm256_shuffle_epi8(hi_table[k],
+                                             _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            res = _mm256_and_si256(res, _mm256_and_si256(lo, hi));
+        }
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(res, zero));
+        if (mask) return j + (size_t)__builtin_ctz(mask);
+    }
+    return find_ssse3(t, data, j, end);
+}
+#endif
+
+ac_teddy_t* ac_teddy_create(const ac_automaton_t* ac) {
+    if (!ac || !ac->is_built || ac->pattern_count == 0
+        || ac->pattern_count > AC_TEDDY_MAX_PATTERNS) {
+        return NULL;
+    }
+
+    size_t n = ac->pattern_count;
+    prefix_t* prefixes = calloc(n, sizeof(prefix_t));
+    ac_teddy_t* t = calloc(1, sizeof(ac_teddy_t));
+    if (!prefixes || !t) {
+        free(prefixes);
+        free(t);
+        return NULL;
+    }
+
+    t->prefix_len = TEDDY_MAX_PREFIX;
+    for (size_t i = 0; i < n; ++i) {
+        size_t len = filtered_prefix(&ac->patterns[i], prefixes[i].bytes, TEDDY_MAX_PREFIX);
+        if (len < t->prefix_len) t->prefix_len = len;
+    }
+    if (t->prefix_len == 0) {
+        free(prefixes);
+        free(t);
+        return NULL;
+    }
+
+    // Prefixos parecidos no mesmo grupo geram menos falsos positivos: os
+    // grupos são faixas contíguas da lista ordenada.
+    qsort(prefixes, n, sizeof(prefix_t), compare_prefix);
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t bucket_bit = (uint8_t)(1u << (i * TEDDY_BUCKETS / n));
+        for (size_t k = 0; k < t->prefix_len; ++k) {
+            uint8_t c = prefixes[i].bytes[k];
+            t->lo[k][c & 0x0f] |= bucket_bit;
+            t->hi[k][c >> 4] |= bucket_bit;
+        }
+    }
+    free(prefixes);
+
+    t->find = find_scalar;
+    t->isa = "scalar";
+#if TEDDY_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        t->find = find_avx2;
+        t->isa = "avx2";
+    } else if (__builtin_cpu_supports("ssse3")) {
+        t->find = find_ssse3;
+        t->isa = "ssse3";
+    }
+#endif
+    return t;
+}
+
+void ac_teddy_free(ac_teddy_t* teddy) {
+    free(teddy);
+}
+
+const char* ac_teddy_isa(const ac_teddy_t* teddy) {
+    return teddy ? teddy->isa : "none";
+}
+
+size_t ac_teddy_find(const ac_teddy_t* teddy, const char* data, size_t from, size_t len) {
+    if (from >= len) return len;
+
+    // Só dá para testar posições com prefix_len bytes disponíveis
+    size_t end = (len >= teddy->prefix_len) ? len - teddy->prefix_len + 1 : 0;
+    if (from >= end) return from;
+    return teddy->find(teddy, (const uint8_t*)data, from, end);
+}
+
+void ac_teddy_feed(const ac_teddy_t* teddy, ac_scanner_t* scanner,
+                   const char* data, size_t len) {
+    size_t i = 0;
+
+    while (i < len) {
+        // Na raiz nenhum match está em andamento, e nenhum começa antes do
+        // próximo candidato
+        if (ac_scanner_at_root(scanner)) {
+            size_t next = ac_teddy_find(teddy, data, i, len);
+            ac_scanner_skip(scanner, next - i);
+            i = next;
+            if (i == len) break;
+        }
+
+        size_t n = (len - i < VERIFY_BLOCK) ? len - i : VERIFY_BLOCK;
+        ac_scanner_feed(scanner, data + i, n);
+        i += n;
+    }
+}
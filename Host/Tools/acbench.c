@@ -0,0 +1,392 @@
+// acbench: mede construção e vazão de busca do motor Aho-Corasick contra
+// laços ingênuos de strstr e memmem, variando número e tamanho dos padrões,
+// densidade de matches e alfabeto.
+//
+//   acbench [-s MB] [-r N] [-p N,N,...] [-q]
+//
+// Cada linha de stdout é um resultado em CSV (cabeçalho na primeira linha).
+// A coluna backend diz qual motor ac_build escolheu para o autômato.
+// Casos que não cabem nos limites de aho_config.h saem com status "skipped".
+
+#define _GNU_SOURCE
+#include "aho_corasick.h"
+#include "ac_builder.h"
+#include "ac_teddy.h"
+#include "aho_shift_or.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Os baselines custam padrões x bytes; o corpus deles é cortado para caber
+// neste orçamento (com um mínimo de 64 KiB) e a vazão é medida sobre o corte.
+#define BASELINE_BUDGET (1ull << 30)
+#define BASELINE_MIN_BYTES (64u << 10)
+
+typedef struct {
+    const char* name;
+    const char* chars;
+} alphabet_t;
+
+typedef struct {
+    const char* name;
+    size_t spacing;                 // Bytes entre matches plantados (0 = nenhum)
+} density_t;
+
+typedef struct {
+    size_t min_len;
+    size_t max_len;
+} length_class_t;
+
+static const alphabet_t alphabets[] = {
+    { "printable", " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                   "[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~" },
+    { "text", "etaoin shrdlucmfwypvbgkjqxz" },
+    { "dna", "acgt" },
+};
+
+static const density_t densities[] = {
+    { "none", 0 },
+    { "low", 64 << 10 },
+    { "high", 256 },
+};
+
+static const length_class_t lengths[] = {
+    { 3, 6 },
+    { 8, 16 },
+    { 16, 32 },
+};
+
+static const size_t default_pattern_counts[] = { 16, 256, 4096, 100000 };
+
+typedef struct {
+    char** patterns;
+    size_t* pattern_lens;
+    size_t count;
+    char* storage;
+} pattern_set_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng_next(void) {
+    // xorshift64*: rápido e reprodutível entre execuções
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+static void random_fill(char* dst, size_t len, const char* chars) {
+    size_t n = strlen(chars);
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] = chars[rng_next() % n];
+    }
+}
+
+static bool make_patterns(pattern_set_t* set, size_t count, const length_class_t* lc,
+                          const alphabet_t* alphabet) {
+    set->count = count;
+    set->patterns = malloc(count * sizeof(char*));
+    set->pattern_lens = malloc(count * sizeof(size_t));
+    set->storage = malloc(count * (lc->max_len + 1));
+    if (!set->patterns || !set->pattern_lens || !set->storage) return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = lc->min_len + rng_next() % (lc->max_len - lc->min_len + 1);
+        char* p = set->storage + i * (lc->max_len + 1);
+        random_fill(p, len, alphabet->chars);
+        p[len] = '\0';
+        set->patterns[i] = p;
+        set->pattern_lens[i] = len;
+    }
+    return true;
+}
+
+static void free_patterns(pattern_set_t* set) {
+    free(set->patterns);
+    free(set->pattern_lens);
+    free(set->storage);
+}
+
+// Texto aleatório do alfabeto com padrões do conjunto plantados a cada
+// spacing bytes. Termina em '\0' para os baselines com strstr.
+static char* make_corpus(size_t len, const alphabet_t* alphabet, const density_t* density,
+                         const pattern_set_t* set) {
+    char* text = malloc(len + 1);
+    if (!text) return NULL;
+
+    random_fill(text, len, alphabet->chars);
+    if (density->spacing > 0) {
+        for (size_t pos = density->spacing / 2; pos < len; pos += density->spacing) {
+            size_t i = rng_next() % set->count;
+            if (pos + set->pattern_lens[i] <= len) {
+                memcpy(text + pos, set->patterns[i], set->pattern_lens[i]);
+            }
+        }
+    }
+    text[len] = '\0';
+    return text;
+}
+
+static void count_match(const ac_match_t* match, void* ctx) {
+    (void)match;
+    ++*(size_t*)ctx;
+}
+
+static size_t scan_automaton(const ac_automaton_t* ac, const char* text, size_t len) {
+    size_t matches = 0;
+    ac_scanner_t scanner;
+    ac_scanner_init(&scanner, ac, count_match, &matches);
+    ac_scanner_feed(&scanner, text, len);
+    return matches;
+}
+
+static size_t scan_teddy(const ac_automaton_t* ac, const ac_teddy_t* teddy,
+                         const char* text, size_t len) {
+    size_t matches = 0;
+    ac_scanner_t scanner;
+    ac_scanner_init(&scanner, ac, count_match, &matches);
+    ac_teddy_feed(teddy, &scanner, text, len);
+    return matches;
+}
+
+static size_t scan_shift_or(const ac_shift_or_t* so, const char* text, size_t len) {
+    size_t matches = 0;
+    ac_shift_or_scanner_t scanner;
+    ac_shift_or_scanner_init(&scanner, so, count_match, &matches);
+    ac_shift_or_feed(&scanner, text, len);
+    return matches;
+}
+
+static size_t scan_strstr(const pattern_set_t* set, const char* text, size_t len) {
+    (void)len;
+    size_t matches = 0;
+    for (size_t i = 0; i < set->count; ++i) {
+        for (const char* p = text; (p = strstr(p, set->patterns[i])) != NULL; ++p) {
+            matches++;
+        }
+    }
+    return matches;
+}
+
+static size_t scan_memmem(const pattern_set_t* set, const char* text, size_t len) {
+    size_t matches = 0;
+    for (size_t i = 0; i < set->count; ++i) {
+        const char* p = text;
+        const char* end = text + len;
+        while ((p = memmem(p, end - p, set->patterns[i], set->pattern_lens[i])) != NULL) {
+            matches++;
+            p++;
+        }
+    }
+    return matches;
+}
+
+static void print_header(void) {
+    printf("engine,patterns,min_len,max_len,alphabet,density,status,states,"
+           "build_ms,bytes,seconds,mb_per_s,ns_per_byte,matches,backend\n");
+}
+
+static void print_row(const char* engine, const pattern_set_t* set, const length_class_t* lc,
+                      const alphabet_t* alphabet, const density_t* density, const char* status,
+                      unsigned states, double build_ms, size_t bytes, double seconds,
+                      size_t matches, const char* backend) {
+    double mbps = seconds > 0 ? bytes / 1e6 / seconds : 0.0;
+    double nspb = bytes > 0 ? seconds * 1e9 / bytes : 0.0;
+    printf("%s,%zu,%zu,%zu,%s,%s,%s,%u,%.3f,%zu,%.6f,%.1f,%.3f,%zu,%s\n",
+           engine, set->count, lc->min_len, lc->max_len, alphabet->name, density->name,
+           status, states, build_ms, bytes, seconds, mbps, nspb, matches, backend);
+    fflush(stdout);
+}
+
+typedef size_t (*baseline_fn)(const pattern_set_t*, const char*, size_t);
+
+static void run_baseline(const char* engine, baseline_fn fn, const pattern_set_t* set,
+                         const length_class_t* lc, const alphabet_t* alphabet,
+                         const density_t* density, char* text, size_t len, int repeats) {
+    size_t bytes = BASELINE_BUDGET / set->count;
+    if (bytes < BASELINE_MIN_BYTES) bytes = BASELINE_MIN_BYTES;
+    if (bytes > len) bytes = len;
+
+    // Corta o texto temporariamente para o strstr
+    char saved = text[bytes];
+    text[bytes] = '\0';
+
+    double best = 0.0;
+    size_t matches = 0;
+    for (int r = 0; r < repeats; ++r) {
+        double t0 = now_seconds();
+        matches = fn(set, text, bytes);
+        double t = now_seconds() - t0;
+        if (r == 0 || t < best) best = t;
+    }
+    text[bytes] = saved;
+
+    print_row(engine, set, lc, alphabet, density, "ok", 0, 0.0, bytes, best, matches, "-");
+}
+
+static void run_case(size_t count, const length_class_t* lc, const alphabet_t* alphabet,
+                     const density_t* density, size_t corpus_len, int repeats,
+                     ac_automaton_t* ac) {
+    pattern_set_t set;
+    if (!make_patterns(&set, count, lc, alphabet)) {
+        fprintf(stderr, "acbench: out of memory\n");
+        exit(2);
+    }
+
+    double t0 = now_seconds();
+    ac_init(ac);
+    ac_builder_t* builder = ac_builder_create(ac);
+    bool fits = builder != NULL;
+    for (size_t i = 0; i < count && fits; ++i) {
+        fits = ac_builder_add(builder, set.patterns[i], set.pattern_lens[i], (ac_pattern_id_t)i, 0, NULL);
+    }
+    ac_builder_free(builder);
+    if (fits) ac_build(ac);
+    double build_ms = (now_seconds() - t0) * 1e3;
+
+    char* text = make_corpus(corpus_len, alphabet, density, &set);
+    if (!text) {
+        fprintf(stderr, "acbench: out of memory\n");
+        exit(2);
+    }
+
+    if (!fits) {
+        print_row("aho_corasick", &set, lc, alphabet, density, "skipped", 0, 0.0, 0, 0.0, 0, "-");
+    } else {
+        double best = 0.0;
+        size_t matches = 0;
+        for (int r = 0; r < repeats; ++r) {
+            double t1 = now_seconds();
+            matches = scan_automaton(ac, text, corpus_len);
+            double t = now_seconds() - t1;
+            if (r == 0 || t < best) best = t;
+        }
+        print_row("aho_corasick", &set, lc, alphabet, density, "ok", ac->vertex_count,
+                  build_ms, corpus_len, best, matches, ac_engine_name(ac_engine(ac)));
+
+        // Mesmo autômato atrás do prefiltro SIMD, quando ele se aplica
+        t0 = now_seconds();
+        ac_teddy_t* teddy = ac_teddy_create(ac);
+        double teddy_ms = build_ms + (now_seconds() - t0) * 1e3;
+        if (!teddy) {
+            print_row("teddy+ac", &set, lc, alphabet, density, "skipped", 0, 0.0, 0, 0.0, 0, "-");
+        } else {
+            for (int r = 0; r < repeats; ++r) {
+                double t1 = now_seconds();
+                matches = scan_teddy(ac, teddy, text, corpus_len);
+                double t = now_seconds() - t1;
+                if (r == 0 || t < best) best = t;
+            }
+            print_row("teddy+ac", &set, lc, alphabet, density, "ok", ac->vertex_count,
+                      teddy_ms, corpus_len, best, matches, ac_engine_name(ac_engine(ac)));
+            ac_teddy_free(teddy);
+        }
+    }
+
+    // Motor bit-paralelo, quando a soma dos padrões cabe numa palavra
+    ac_shift_or_t so;
+    t0 = now_seconds();
+    ac_shift_or_init(&so);
+    bool so_fits = true;
+    for (size_t i = 0; i < count && so_fits; ++i) {
+        so_fits = ac_shift_or_add_pattern_ex(&so, set.patterns[i], set.pattern_lens[i],
+                                             (ac_pattern_id_t)i, 0, NULL);
+    }
+    double so_ms = (now_seconds() - t0) * 1e3;
+    if (!so_fits) {
+        print_row("shift_or", &set, lc, alphabet, density, "skipped", 0, 0.0, 0, 0.0, 0, "-");
+    } else {
+        double best = 0.0;
+        size_t matches = 0;
+        for (int r = 0; r < repeats; ++r) {
+            double t1 = now_seconds();
+            matches = scan_shift_or(&so, text, corpus_len);
+            double t = now_seconds() - t1;
+            if (r == 0 || t < best) best = t;
+        }
+        print_row("shift_or", &set, lc, alphabet, density, "ok", 0, so_ms, corpus_len, best, matches,
+                  "shift_or");
+    }
+
+    run_baseline("strstr", scan_strstr, &set, lc, alphabet, density, text, corpus_len, repeats);
+    run_baseline("memmem", scan_memmem, &set, lc, alphabet, density, text, corpus_len, repeats);
+
+    free(text);
+    free_patterns(&set);
+}
+
+// Lista de quantidades separadas por vírgula. Retorna 0 se alguma entrada
+// for vazia, zero, tiver algo além de dígitos ou passar de max entradas:
+// uma quantidade 0 dividiria por zero na escolha dos padrões.
+static size_t parse_counts(const char* arg, size_t* counts, size_t max) {
+    size_t n = 0;
+    while (true) {
+        char* end;
+        if (n == max || !isdigit((unsigned char)*arg)) return 0;
+        unsigned long long value = strtoull(arg, &end, 10);
+        if (value == 0 || (*end != ',' && *end != '\0')) return 0;
+        counts[n++] = (size_t)value;
+        if (*end == '\0') return n;
+        arg = end + 1;
+    }
+}
+
+static int usage(void) {
+    fprintf(stderr, "usage: acbench [-s MB] [-r N] [-p N,N,...] [-q]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    size_t corpus_mb = 16;
+    int repeats = 3;
+    bool quick = false;
+    size_t counts[16];
+    size_t num_counts = sizeof(default_pattern_counts) / sizeof(default_pattern_counts[0]);
+    memcpy(counts, default_pattern_counts, sizeof(default_pattern_counts));
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:r:p:q")) != -1) {
+        switch (opt) {
+            case 's': corpus_mb = strtoull(optarg, NULL, 10); break;
+            case 'r': repeats = atoi(optarg); break;
+            case 'p': num_counts = parse_counts(optarg, counts, 16); break;
+            case 'q': quick = true; break;
+            default: return usage();
+        }
+    }
+    if (corpus_mb == 0 || repeats < 1 || num_counts == 0) return usage();
+
+    ac_automaton_t* ac = malloc(sizeof(ac_automaton_t));
+    if (!ac) return 2;
+
+    // -q: só o alfabeto imprimível, padrões curtos e densidade baixa
+    size_t num_alphabets = quick ? 1 : sizeof(alphabets) / sizeof(alphabets[0]);
+    size_t num_densities = sizeof(densities) / sizeof(densities[0]);
+    size_t num_lengths = sizeof(lengths) / sizeof(lengths[0]);
+
+    print_header();
+    for (size_t c = 0; c < num_counts; ++c) {
+        for (size_t l = 0; l < num_lengths; ++l) {
+            if (quick && l != 0) continue;
+            for (size_t a = 0; a < num_alphabets; ++a) {
+                for (size_t d = 0; d < num_densities; ++d) {
+                    if (quick && d != 1) continue;
+                    run_case(counts[c], &lengths[l], &alphabets[a], &densities[d],
+                             corpus_mb << 20, repeats, ac);
+                }
+            }
+        }
+    }
+
+    free(ac);
+    return 0;
+}
@@ -0,0 +1,370 @@
+// acgrep: busca de múltiplos padrões em arquivos ou na entrada padrão com o
+// motor Aho-Corasick do firmware.
+//
+//   acgrep [-c] [-q] [-j N] -f PATTERNS [-T CORPUS] [-o IMAGE] [FILE...]
+//   acgrep [-c] [-q] [-j N] -a IMAGE [FILE...]
+//
+// Arquivos regulares são mapeados com mmap e varridos em paralelo; a entrada
+// padrão, pipes e FIFOs são lidos em blocos grandes e alimentados num único
+// scanner. Cada match é
+// impresso como "arquivo:offset:padrão"; com -c, só a contagem por arquivo.
+// O resumo com a vazão em MB/s vai para stderr (omitido com -q).
+//
+// Com -T, o autômato é treinado sobre um corpus representativo antes de ser
+// salvo: as arestas de cada estado são reordenadas pela frequência de uso,
+// para que a busca linear encontre primeiro as transições mais comuns, e os
+// vértices são renumerados para que os estados quentes fiquem juntos. O
+// mesmo corpus define a frequência de bytes usada para escolher o byte
+// raro de cada padrão no prefiltro (só vale nesta execução; a imagem salva
+// não guarda o prefiltro).
+
+#include "aho_corasick.h"
+#include "ac_builder.h"
+#include "ac_image.h"
+#include "ac_parallel.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STREAM_BLOCK_SIZE (1u << 20)
+
+typedef struct {
+    const char* name;
+    bool count_only;
+    size_t matches;
+} file_scan_t;
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: acgrep [-c] [-q] [-j N] (-f PATTERNS [-T CORPUS] [-o IMAGE] | -a IMAGE) [FILE...]\n"
+            "  -f PATTERNS  one pattern per line\n"
+            "  -a IMAGE     load a serialized automaton\n"
+            "  -T CORPUS    lay out states and transitions by their frequency in CORPUS\n"
+            "  -o IMAGE     save the automaton built from -f\n"
+            "  -c           print only the match count per file\n"
+            "  -j N         threads for the build and per file (default: all online cores)\n"
+            "  -q           do not print the throughput summary\n");
+}
+
+// Argumento de -j: decimal positivo. Retorna 0 se for inválido.
+static unsigned parse_threads(const char* arg) {
+    char* end;
+    if (!isdigit((unsigned char)*arg)) return 0;
+    unsigned long value = strtoul(arg, &end, 10);
+    if (*end != '\0' || value > UINT_MAX) return 0;
+    return (unsigned)value;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char* read_file(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    size_t capacity = 1 << 16, size = 0;
+    char* data = malloc(capacity);
+    while (data) {
+        size += fread(data + size, 1, capacity - size, f);
+        if (size < capacity) break;
+        char* grown = realloc(data, capacity * 2);
+        if (!grown) {
+            free(data);
+            data = NULL;
+        } else {
+            data = grown;
+            capacity *= 2;
+        }
+    }
+    fclose(f);
+    *len = size;
+    return data;
+}
+
+// Próxima linha não vazia a partir de *pos, sem o '\n' e o '\r' finais.
+// Retorna NULL no fim do texto.
+static const char* next_line(const char* text, size_t len, size_t* pos,
+                             size_t* line_len, size_t* line_no) {
+    while (*pos < len) {
+        const char* line = text + *pos;
+        const char* nl = memchr(line, '\n', len - *pos);
+        size_t n = nl ? (size_t)(nl - line) : len - *pos;
+        *pos += n + 1;
+        (*line_no)++;
+
+        if (n > 0 && line[n - 1] == '\r') n--;
+        if (n > 0) {
+            *line_len = n;
+            return line;
+        }
+    }
+    return NULL;
+}
+
+// Feeds de regras costumam vir ordenados; nesse caso o Trie sai numa única
+// passada com ac_add_sorted_patterns. Retorna false se a lista não estiver
+// ordenada (ou não couber), e o chamador recomeça pelo ac_builder.
+static bool add_sorted(ac_automaton_t* ac, const char* text, size_t len) {
+    ac_pattern_t* list = NULL;
+    size_t count = 0, capacity = 0, pos = 0, line_len, line_no = 0;
+    const char* line;
+
+    while ((line = next_line(text, len, &pos, &line_len, &line_no)) != NULL) {
+        if (line_len > UINT8_MAX) break;
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 1024;
+            ac_pattern_t* grown = realloc(list, capacity * sizeof(ac_pattern_t));
+            if (!grown) break;
+            list = grown;
+        }
+        list[count].bytes = line;
+        list[count].user_data = NULL;
+        list[count].id = (ac_pattern_id_t)count;
+        list[count].length = (uint8_t)line_len;
+        list[count].flags = 0;
+        count++;
+    }
+
+    bool ok = line == NULL && ac_add_sorted_patterns(ac, list, count);
+    free(list);
+    return ok;
+}
+
+// Carrega um padrão por linha no Trie, ainda sem ac_build. Os padrões
+// apontam para dentro de *storage, que precisa viver tanto quanto o autômato.
+static ac_automaton_t* load_patterns(const char* path, char** storage) {
+    size_t len;
+    char* text = read_file(path, &len);
+    if (!text) {
+        fprintf(stderr, "acgrep: %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    ac_automaton_t* ac = malloc(sizeof(ac_automaton_t));
+    if (!ac) {
+        free(text);
+        return NULL;
+    }
+    ac_init(ac);
+    if (add_sorted(ac, text, len)) {
+        *storage = text;
+        return ac;
+    }
+
+    ac_init(ac);
+    ac_builder_t* builder = ac_builder_create(ac);
+    if (!builder) {
+        free(ac);
+        free(text);
+        return NULL;
+    }
+
+    size_t pos = 0, line_len, line_no = 0;
+    const char* line;
+    while ((line = next_line(text, len, &pos, &line_len, &line_no)) != NULL) {
+        if (!ac_builder_add(builder, line, line_len, (ac_pattern_id_t)ac->pattern_count, 0, NULL)) {
+            fprintf(stderr, "acgrep: %s:%zu: pattern does not fit in the automaton\n", path, line_no);
+            ac_builder_free(builder);
+            free(ac);
+            free(text);
+            return NULL;
+        }
+    }
+
+    ac_builder_free(builder);
+    *storage = text;
+    return ac;
+}
+
+static bool train_transitions(ac_automaton_t* ac, const char* corpus_path) {
+    size_t len;
+    char* corpus = read_file(corpus_path, &len);
+    if (!corpus) return false;
+
+    static ac_profile_t profile;
+    ac_profile_init(&profile);
+    ac_profile_feed(&profile, ac, corpus, len);
+    ac_reorder_transitions(ac, &profile);
+    ac_renumber_vertices(ac, &profile);
+
+    // Bytes raros do prefiltro escolhidos pela frequência no próprio corpus
+    static uint32_t byte_freq[256];
+    ac_count_bytes(byte_freq, corpus, len);
+    ac_set_byte_frequencies(ac, byte_freq);
+    ac_build_prefilter(ac);
+    free(corpus);
+    return true;
+}
+
+static void on_match(const ac_match_t* match, void* ctx) {
+    file_scan_t* scan = (file_scan_t*)ctx;
+
+    scan->matches++;
+    if (!scan->count_only) {
+        printf("%s:%zu:%.*s\n", scan->name, match->start,
+               (int)match->pattern->length, match->pattern->bytes);
+    }
+}
+
+static bool scan_stream(const ac_automaton_t* ac, FILE* in, file_scan_t* scan, size_t* bytes) {
+    char* block = malloc(STREAM_BLOCK_SIZE);
+    if (!block) return false;
+
+    ac_scanner_t scanner;
+    ac_scanner_init(&scanner, ac, on_match, scan);
+
+    size_t n;
+    while ((n = fread(block, 1, STREAM_BLOCK_SIZE, in)) > 0) {
+        ac_scanner_feed(&scanner, block, n);
+    }
+    *bytes = scanner.position;
+    free(block);
+    return !ferror(in);
+}
+
+// Só arquivos regulares têm tamanho e podem ser mapeados; o resto (FIFOs,
+// <(cmd), /dev/stdin) passa pela mesma leitura em blocos da entrada padrão.
+static bool scan_path(const ac_automaton_t* ac, const char* path, unsigned threads,
+                      file_scan_t* scan, size_t* bytes) {
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+
+    if (S_ISREG(st.st_mode)) {
+        if (!ac_parallel_scan_file(ac, path, threads, on_match, scan)) return false;
+        *bytes = (size_t)st.st_size;
+        return true;
+    }
+
+    FILE* in = fopen(path, "rb");
+    if (!in) return false;
+    bool ok = scan_stream(ac, in, scan, bytes);
+    int saved_errno = errno;
+    fclose(in);
+    errno = saved_errno;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* patterns_path = NULL;
+    const char* image_in = NULL;
+    const char* image_out = NULL;
+    const char* corpus_path = NULL;
+    bool count_only = false, quiet = false;
+    unsigned threads = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:a:o:T:cj:qh")) != -1) {
+        switch (opt) {
+            case 'f': patterns_path = optarg; break;
+            case 'a': image_in = optarg; break;
+            case 'o': image_out = optarg; break;
+            case 'T': corpus_path = optarg; break;
+            case 'c': count_only = true; break;
+            case 'j':
+                threads = parse_threads(optarg);
+                if (threads == 0) {
+                    usage();
+                    return 2;
+                }
+                break;
+            case 'q': quiet = true; break;
+            default: usage(); return 2;
+        }
+    }
+    if (!patterns_path == !image_in) {
+        usage();
+        return 2;
+    }
+
+    char* storage = NULL;
+    double t0 = now_seconds();
+    ac_automaton_t* ac = patterns_path ? load_patterns(patterns_path, &storage)
+                                       : ac_image_load(image_in);
+    if (!ac) {
+        if (image_in) fprintf(stderr, "acgrep: %s: invalid automaton image\n", image_in);
+        return 2;
+    }
+    double load_time = now_seconds() - t0;
+
+    if (patterns_path) {
+        t0 = now_seconds();
+        ac_build_parallel(ac, threads);
+        double link_time = now_seconds() - t0;
+        if (!quiet) {
+            fprintf(stderr, "acgrep: built %u patterns, %u states: trie %.3f ms, links %.3f ms, "
+                    "engine %s\n",
+                    (unsigned)ac->pattern_count, (unsigned)ac->vertex_count,
+                    load_time * 1e3, link_time * 1e3, ac_engine_name(ac_engine(ac)));
+        }
+        load_time += link_time;
+    }
+
+    if (corpus_path && !train_transitions(ac, corpus_path)) {
+        fprintf(stderr, "acgrep: %s: %s\n", corpus_path, strerror(errno));
+        return 2;
+    }
+
+    if (image_out) {
+        if (!ac_image_save(ac, image_out)) {
+            fprintf(stderr, "acgrep: %s: %s\n", image_out, strerror(errno));
+            return 2;
+        }
+        if (optind == argc) return 0; // Só compilar os padrões
+    }
+
+    static char out_buffer[1 << 16];
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    int status = 1;
+    size_t total_bytes = 0, total_matches = 0;
+    double scan_time = 0.0;
+    int num_inputs = (optind < argc) ? argc - optind : 1;
+
+    for (int i = 0; i < num_inputs; ++i) {
+        const char* path = (optind < argc) ? argv[optind + i] : "-";
+        bool from_stdin = strcmp(path, "-") == 0;
+        file_scan_t scan = { from_stdin ? "(stdin)" : path, count_only, 0 };
+        size_t bytes = 0;
+        bool ok;
+
+        t0 = now_seconds();
+        if (from_stdin) {
+            ok = scan_stream(ac, stdin, &scan, &bytes);
+        } else {
+            ok = scan_path(ac, path, threads, &scan, &bytes);
+        }
+        scan_time += now_seconds() - t0;
+
+        if (!ok) {
+            fprintf(stderr, "acgrep: %s: %s\n", path, strerror(errno));
+            status = 2;
+            continue;
+        }
+        if (count_only) printf("%s:%zu\n", scan.name, scan.matches);
+        if (scan.matches > 0 && status == 1) status = 0;
+        total_bytes += bytes;
+        total_matches += scan.matches;
+    }
+    fflush(stdout);
+
+    if (!quiet) {
+        double mb = total_bytes / 1e6;
+        fprintf(stderr, "acgrep: %u patterns, %u states, loaded in %.3f ms; "
+                "%zu bytes in %.3f s (%.1f MB/s), %zu matches\n",
+                (unsigned)ac->pattern_count, (unsigned)ac->vertex_count, load_time * 1e3,
+                total_bytes, scan_time, scan_time > 0 ? mb / scan_time : 0.0, total_matches);
+    }
+
+    free(ac);
+    free(storage);
+    return status;
+}